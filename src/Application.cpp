@@ -104,6 +104,7 @@ bool Application::initEmulators() {
 
     currentCore = availableCores[1];
     emulator = createEmulator(currentCore);
+    input.setCore(currentCore);
 
     return true;
 }
@@ -134,7 +135,7 @@ void Application::processEvents() {
 
 void Application::update() {
     audio.update();
-    input.updateEmulator(emulator.get(), emulator ? emulator->getArchName() : "");
+    input.updateEmulator(emulator.get());
 
     if (emulator && rom_loaded && !mainWindow.isPaused()) {
         emulator->runFrame();
@@ -181,6 +182,7 @@ void Application::handleUserActions() {
     if (mainWindow.shouldSelectCore()) {
         currentCore = mainWindow.getRequestedCore();
         emulator = createEmulator(currentCore);
+        input.setCore(currentCore);
         rom_loaded = false;
         mainWindow.clearFlags();
     }
@@ -18,6 +18,18 @@ public:
 
     virtual void setButton(int button, bool pressed) = 0;
 
+    // Tous les boutons d'un coup : bit i = bouton i appuyé (numérotation de
+    // setButton). Point d'entrée commun au clavier, au rejeu d'entrées et aux agents
+    virtual void setButtonMask(uint32_t mask) {
+        for (int i = 0; i < 32; ++i) setButton(i, (mask >> i) & 1);
+    }
+    // Masque horodaté : framePosition (0-1) situe le changement dans la
+    // prochaine frame émulée. Par défaut, appliqué tout de suite
+    virtual void setButtonMaskAt(uint32_t mask, double framePosition) {
+        (void)framePosition;
+        setButtonMask(mask);
+    }
+
     virtual std::string getArchName() const = 0;
     virtual const uint8_t* getMemoryPtr() const = 0;
     virtual size_t getMemorySize() const = 0;
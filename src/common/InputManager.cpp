@@ -2,87 +2,93 @@
 #include "common/EmulatorInterface.h"
 #include "utils/Logger.h"
 
-InputManager::InputManager() {
-    buttonStates.fill(false);
-}
+#include <initializer_list>
+#include <utility>
 
-void InputManager::processEvent(const SDL_Event& event) {
-    if (event.type == SDL_EVENT_KEY_DOWN || event.type == SDL_EVENT_KEY_UP) {
-        bool pressed = (event.type == SDL_EVENT_KEY_DOWN);
+namespace {
 
-        // Essaye CHIP-8
-        EmulatorButton chip8_btn = sdlKeyToChip8Button(event.key.key);
-        if (chip8_btn != EmulatorButton::COUNT) {
-            buttonStates[static_cast<size_t>(chip8_btn)] = pressed;
-            return;
-        }
-
-        // Essaye Game Boy
-        EmulatorButton gb_btn = sdlKeyToGameBoyButton(event.key.key);
-        if (gb_btn != EmulatorButton::COUNT) {
-            buttonStates[static_cast<size_t>(gb_btn)] = pressed;
-            return;
-        }
+InputManager::KeyMap buildKeyMap(std::initializer_list<std::pair<SDL_Scancode, int>> keys) {
+    InputManager::KeyMap map;
+    map.fill(-1);
+    for (const auto& [scancode, bit] : keys) {
+        map[scancode] = static_cast<int8_t>(bit);
     }
+    return map;
 }
 
-void InputManager::updateEmulator(IEmulator* emulator, const std::string& coreName) {
-    if (!emulator) return;
+} // namespace
 
-    if (coreName == "CHIP-8") {
-        for (int i = 0; i < 16; ++i) {
-            EmulatorButton btn = static_cast<EmulatorButton>(static_cast<int>(EmulatorButton::CHIP8_0) + i);
-            emulator->setButton(i, buttonStates[static_cast<size_t>(btn)]);
-        }
-    } else if (coreName == "Game Boy") {
+const InputManager::KeyMap& InputManager::chip8KeyMap() {
+    // Pavé 4x4 sous les chiffres :  1 2 3 C / 4 5 6 D / 7 8 9 E / A 0 B F
+    static const KeyMap map = buildKeyMap({
+        {SDL_SCANCODE_1, 0x1}, {SDL_SCANCODE_2, 0x2}, {SDL_SCANCODE_3, 0x3}, {SDL_SCANCODE_4, 0xC},
+        {SDL_SCANCODE_Q, 0x4}, {SDL_SCANCODE_W, 0x5}, {SDL_SCANCODE_E, 0x6}, {SDL_SCANCODE_R, 0xD},
+        {SDL_SCANCODE_A, 0x7}, {SDL_SCANCODE_S, 0x8}, {SDL_SCANCODE_D, 0x9}, {SDL_SCANCODE_F, 0xE},
+        {SDL_SCANCODE_Z, 0xA}, {SDL_SCANCODE_X, 0x0}, {SDL_SCANCODE_C, 0xB}, {SDL_SCANCODE_V, 0xF},
+    });
+    return map;
+}
 
-        emulator->setButton(0, buttonStates[static_cast<size_t>(EmulatorButton::GB_A)]);
-        emulator->setButton(1, buttonStates[static_cast<size_t>(EmulatorButton::GB_B)]);
-        emulator->setButton(2, buttonStates[static_cast<size_t>(EmulatorButton::GB_SELECT)]);
-        emulator->setButton(3, buttonStates[static_cast<size_t>(EmulatorButton::GB_START)]);
-        emulator->setButton(4, buttonStates[static_cast<size_t>(EmulatorButton::GB_RIGHT)]);
-        emulator->setButton(5, buttonStates[static_cast<size_t>(EmulatorButton::GB_LEFT)]);
-        emulator->setButton(6, buttonStates[static_cast<size_t>(EmulatorButton::GB_UP)]);
-        emulator->setButton(7, buttonStates[static_cast<size_t>(EmulatorButton::GB_DOWN)]);
-    }
+const InputManager::KeyMap& InputManager::gameBoyKeyMap() {
+    // Bits de GB_Joypad::Button : A, B, Select, Start, Droite, Gauche, Haut, Bas
+    static const KeyMap map = buildKeyMap({
+        {SDL_SCANCODE_Q, 0},  // A (touche A en AZERTY)
+        {SDL_SCANCODE_W, 1},  // B (touche Z en AZERTY)
+        {SDL_SCANCODE_T, 2},  // Select
+        {SDL_SCANCODE_R, 3},  // Start
+        {SDL_SCANCODE_L, 4},  // Droite
+        {SDL_SCANCODE_J, 5},  // Gauche
+        {SDL_SCANCODE_I, 6},  // Haut
+        {SDL_SCANCODE_K, 7},  // Bas
+    });
+    return map;
 }
 
-bool InputManager::isKeyPressed(EmulatorButton button) const {
-    return buttonStates[static_cast<size_t>(button)];
+void InputManager::setCore(EmulatorCore core) {
+    switch (core) {
+        case EmulatorCore::CHIP8:   keyMap = &chip8KeyMap(); break;
+        case EmulatorCore::GameBoy: keyMap = &gameBoyKeyMap(); break;
+        default:                    keyMap = nullptr; break;
+    }
+
+    buttonMask = 0;
+    timedInputs.clear();
 }
 
-EmulatorButton InputManager::sdlKeyToChip8Button(SDL_Keycode key) {
-    switch (key) {
-        case SDLK_X: return EmulatorButton::CHIP8_0;
-        case SDLK_1: return EmulatorButton::CHIP8_1;
-        case SDLK_2: return EmulatorButton::CHIP8_2;
-        case SDLK_3: return EmulatorButton::CHIP8_3;
-        case SDLK_A: return EmulatorButton::CHIP8_4;
-        case SDLK_Z: return EmulatorButton::CHIP8_5;
-        case SDLK_E: return EmulatorButton::CHIP8_6;
-        case SDLK_Q: return EmulatorButton::CHIP8_7;
-        case SDLK_S: return EmulatorButton::CHIP8_8;
-        case SDLK_D: return EmulatorButton::CHIP8_9;
-        case SDLK_W: return EmulatorButton::CHIP8_A;
-        case SDLK_C: return EmulatorButton::CHIP8_B;
-        case SDLK_4: return EmulatorButton::CHIP8_C;
-        case SDLK_R: return EmulatorButton::CHIP8_D;
-        case SDLK_F: return EmulatorButton::CHIP8_E;
-        case SDLK_V: return EmulatorButton::CHIP8_F;
-        default: return EmulatorButton::COUNT;
+void InputManager::processEvent(const SDL_Event& event) {
+    if (event.type != SDL_EVENT_KEY_DOWN && event.type != SDL_EVENT_KEY_UP) return;
+    if (event.key.repeat || !keyMap) return;
+
+    int bit = (*keyMap)[event.key.scancode];
+    if (bit < 0) return;
+
+    uint32_t mask = buttonMask;
+    if (event.type == SDL_EVENT_KEY_DOWN) {
+        mask |= (1u << bit);
+    } else {
+        mask &= ~(1u << bit);
     }
+    if (mask == buttonMask) return;
+
+    buttonMask = mask;
+    timedInputs.push_back({mask, event.key.timestamp});
 }
 
-EmulatorButton InputManager::sdlKeyToGameBoyButton(SDL_Keycode key) {
-    switch (key) {
-        case SDLK_A: return EmulatorButton::GB_A;
-        case SDLK_Z: return EmulatorButton::GB_B;
-        case SDLK_R: return EmulatorButton::GB_START;
-        case SDLK_T: return EmulatorButton::GB_SELECT;
-        case SDLK_I: return EmulatorButton::GB_UP;
-        case SDLK_K: return EmulatorButton::GB_DOWN;
-        case SDLK_J: return EmulatorButton::GB_LEFT;
-        case SDLK_L: return EmulatorButton::GB_RIGHT;
-        default: return EmulatorButton::COUNT;
+void InputManager::updateEmulator(IEmulator* emulator) {
+    Uint64 now = SDL_GetTicksNS();
+    Uint64 span = now - lastUpdate;
+
+    // La frame émulée juste après couvre l'intervalle hôte écoulé depuis la
+    // dernière mise à jour : chaque changement y garde sa position relative
+    if (emulator) {
+        for (const TimedInput& input : timedInputs) {
+            double position = (lastUpdate != 0 && span != 0)
+                ? (static_cast<double>(input.timestamp) - static_cast<double>(lastUpdate)) / span
+                : 0.0;
+            emulator->setButtonMaskAt(input.mask, position);
+        }
     }
-}
\ No newline at end of file
+
+    timedInputs.clear();
+    lastUpdate = now;
+}
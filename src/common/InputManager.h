@@ -1,36 +1,42 @@
 #pragma once
 #include <SDL3/SDL.h>
+#include "common/EmulatorCore.h"
 #include <array>
-#include <string>
-
-enum class EmulatorButton {
-    // CHIP-8 (16 boutons)
-    CHIP8_0, CHIP8_1, CHIP8_2, CHIP8_3,
-    CHIP8_4, CHIP8_5, CHIP8_6, CHIP8_7,
-    CHIP8_8, CHIP8_9, CHIP8_A, CHIP8_B,
-    CHIP8_C, CHIP8_D, CHIP8_E, CHIP8_F,
-
-    // Game Boy
-    GB_A, GB_B, GB_START, GB_SELECT,
-    GB_UP, GB_DOWN, GB_LEFT, GB_RIGHT,
-
-    COUNT
-};
+#include <cstdint>
+#include <vector>
 
 class IEmulator;
 
+// Clavier → masque de boutons du core courant (IEmulator::setButtonMask).
+// Chaque core a sa table scancode → bit, construite une fois et choisie à la
+// sélection du core. Les scancodes désignent une position physique : la
+// disposition du clavier (AZERTY, QWERTY...) ne change pas le placement.
 class InputManager {
 public:
-    InputManager();
+    // Bit du bouton dans le masque, -1 si la touche n'est pas utilisée
+    using KeyMap = std::array<int8_t, SDL_SCANCODE_COUNT>;
+
+    void setCore(EmulatorCore core);
 
     void processEvent(const SDL_Event& event);
-    void updateEmulator(IEmulator* emulator, const std::string& coreName);
+    void updateEmulator(IEmulator* emulator);
 
-    bool isKeyPressed(EmulatorButton button) const;
+    uint32_t getButtonMask() const { return buttonMask; }
+    bool isButtonPressed(int bit) const { return (buttonMask >> bit) & 1; }
 
 private:
-    std::array<bool, static_cast<size_t>(EmulatorButton::COUNT)> buttonStates{};
-
-    EmulatorButton sdlKeyToChip8Button(SDL_Keycode key);
-    EmulatorButton sdlKeyToGameBoyButton(SDL_Keycode key);
-};
\ No newline at end of file
+    const KeyMap* keyMap = nullptr;
+    uint32_t buttonMask = 0;
+
+    // Masques successifs depuis la dernière mise à jour, avec l'horodatage SDL
+    // (ns) : l'émulateur les replace à la même position dans sa frame
+    struct TimedInput {
+        uint32_t mask;
+        Uint64 timestamp;
+    };
+    std::vector<TimedInput> timedInputs;
+    Uint64 lastUpdate = 0;
+
+    static const KeyMap& chip8KeyMap();
+    static const KeyMap& gameBoyKeyMap();
+};
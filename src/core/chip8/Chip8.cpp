@@ -1,7 +1,8 @@
 #include "core/chip8/Chip8.h"
 #include "utils/Logger.h"
+#include "utils/FileUtils.h"
 
-#include <fstream>
+#include <algorithm>
 
 static const uint8_t CHIP8_FONTSET[80] = {
     0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
@@ -43,14 +44,13 @@ Chip8::Chip8() {
 
 bool Chip8::loadROM(const std::string& path) {
     LOG_INFO("Loading ROM: {}", path);
-    std::ifstream file(path, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
+    FileUtils::RomImagePtr rom = FileUtils::openRomImage(path);
+    if (!rom) {
         LOG_ERROR("Failed to open ROM file: {}", path);
         return false;
     }
     
-    size_t size = file.tellg();
-    file.seekg(0);
+    size_t size = rom->size();
     
     LOG_DEBUG("ROM size: {} bytes", size);
     if (size > 4096 - 0x200) {
@@ -58,7 +58,8 @@ bool Chip8::loadROM(const std::string& path) {
         return false; 
     }
     
-    file.read(reinterpret_cast<char*>(&memory[0x200]), size);
+    // Le programme peut se modifier lui-même : copie dans la RAM
+    std::copy(rom->data(), rom->data() + size, memory.begin() + 0x200);
     LOG_INFO("ROM loaded successfully");
 
     //repeat 
@@ -125,6 +126,12 @@ void Chip8::setButton(int button, bool pressed) {
     }
 }
 
+void Chip8::setButtonMask(uint32_t mask) {
+    for (int i = 0; i < 16; ++i) {
+        keypad[i] = (mask >> i) & 1;
+    }
+}
+
 void Chip8::loadFontset() {
     // Font sprites vont de 0x000 à 0x04F
     for (int i = 0; i < 80; ++i) {
@@ -18,6 +18,7 @@ public:
     int getScreenHeight() const override { return 32; }
     
     void setButton(int button, bool pressed) override;
+    void setButtonMask(uint32_t mask) override;
     std::string getArchName() const override { return "CHIP-8"; }
     uint16_t getPC() const override{ return pc; }
     const uint8_t* getMemoryPtr() const override{ return memory.data();};
@@ -1,15 +1,24 @@
 #include "core/gameboy/GB_CPU.h"
 
-#include "GB_PPU.h"
 #include "core/gameboy/GB_MMU.h"
-#include "core/gameboy/GB_PPU.h"
-#include "core/gameboy/GB_Timer.h"
+#include "core/gameboy/GB_Scheduler.h"
+#include "core/gameboy/GB_Interrupts.h"
 #include "utils/Logger.h"
 
-GB_CPU::GB_CPU(GB_MMU& mmu, GB_PPU& ppu, GB_Timer& timer) : mmu(mmu), ppu(ppu), timer(timer) {
+#include <algorithm>
+
+GB_CPU::GB_CPU(GB_MMU& mmu, GB_Scheduler& scheduler, GB_Interrupts& interrupts)
+    : mmu(mmu), scheduler(scheduler), interrupts(interrupts) {
+    // Écriture dans une page de RAM qui contient des blocs décodés
+    mmu.setCodeWriteHandler(
+        [](void* ctx, uint32_t codePage) { static_cast<GB_CPU*>(ctx)->invalidateCodePage(codePage); },
+        this);
+
     reset();
 }
 
+GB_CPU::~GB_CPU() = default;
+
 void GB_CPU::reset() {
     // Post BootRom
     af = 0x01B0;
@@ -20,17 +29,24 @@ void GB_CPU::reset() {
     pc = 0x0100;
 
     f &=  0xF0; //Force le masque sur les flags
+    lazy = {};
 
     ime = false;
     imeScheduled = false;
     halted = false;
     cycles = 0;
 
+    idleLoop = {};
+    idleStats = {};
+    clearBlockCache();
+
     LOG_INFO("GB CPU reset - PC: {:#06x}", pc);
 }
 
 void GB_CPU::step() {
-    handleInterrupts(mmu);
+    if (interrupts.getPending()) {
+        handleInterrupts();
+    }
 
     if (imeScheduled) {
         ime = true;
@@ -38,12 +54,12 @@ void GB_CPU::step() {
     }
 
     if (halted) {
-        uint8_t IF = mmu.read(0xFF0F);
-        uint8_t IE = mmu.read(0xFFFF);
-        if ((IF & IE & 0x1F) != 0) {
+        if (interrupts.getPending()) {
             halted = false;
         } else {
-            addCycles(4);
+            // ⚡ Seul un événement planifié (PPU, timer...) peut lever une interruption :
+            // on saute directement jusqu'à lui au lieu d'avancer par pas de 4 cycles
+            addCycles(haltSkipCycles());
             return;
         }
     }
@@ -51,409 +67,438 @@ void GB_CPU::step() {
     uint8_t opcode = mmu.read(pc++);
     addCycles(4);
     execute(opcode);
+}
+
+void GB_CPU::run(uint64_t until) {
+    if (backend != GB_CPUBackend::Interpreter) {
+        while (scheduler.now() < until) {
+            if (!runBlock(until)) step();
+        }
+        return;
+    }
+
+    while (scheduler.now() < until) {
+        step();
+    }
+}
+
+uint8_t GB_CPU::evalLazyFlags() const {
+    const LazyFlags& l = lazy;
+    uint8_t flags = (l.result == 0) ? Z_FLAG : 0;
+
+    switch (l.op) {
+        case FlagOp::Add:
+            if (((l.lhs & 0x0F) + (l.rhs & 0x0F) + l.carry) > 0x0F) flags |= H_FLAG;
+            if ((l.lhs + l.rhs + l.carry) > 0xFF) flags |= C_FLAG;
+            break;
+        case FlagOp::Sub:
+            flags |= N_FLAG;
+            if (((l.lhs & 0x0F) - (l.rhs & 0x0F) - l.carry) < 0) flags |= H_FLAG;
+            if ((l.lhs - l.rhs - l.carry) < 0) flags |= C_FLAG;
+            break;
+        case FlagOp::And:
+            flags |= H_FLAG;
+            break;
+        case FlagOp::Or:
+            break;
+        case FlagOp::Inc:
+            if ((l.result & 0x0F) == 0x00) flags |= H_FLAG;
+            if (l.carry) flags |= C_FLAG;
+            break;
+        case FlagOp::Dec:
+            flags |= N_FLAG;
+            if ((l.result & 0x0F) == 0x0F) flags |= H_FLAG;
+            if (l.carry) flags |= C_FLAG;
+            break;
+        case FlagOp::None:
+            return f;
+    }
+    return flags;
+}
 
-    mmu.dbg_serial();
+uint8_t GB_CPU::getCarry() const {
+    const LazyFlags& l = lazy;
+    switch (l.op) {
+        case FlagOp::Add: return (l.lhs + l.rhs + l.carry) > 0xFF ? 1 : 0;
+        case FlagOp::Sub: return (l.lhs - l.rhs - l.carry) < 0 ? 1 : 0;
+        case FlagOp::And:
+        case FlagOp::Or:  return 0;
+        case FlagOp::Inc:
+        case FlagOp::Dec: return l.carry;
+        case FlagOp::None: break;
+    }
+    return (f & C_FLAG) ? 1 : 0;
+}
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+// Les deux tables (page principale et page CB) sont générées à la compilation :
+// une instanciation de op<OP>/opCB<OP> par opcode, sans switch ni lambda au runtime.
+
+template<std::size_t... I>
+constexpr std::array<GB_CPU::OpHandler, 256> GB_CPU::makeOpTable(std::index_sequence<I...>) {
+    return {{ &GB_CPU::op<static_cast<uint8_t>(I)>... }};
+}
+
+template<std::size_t... I>
+constexpr std::array<GB_CPU::OpHandler, 256> GB_CPU::makeCBTable(std::index_sequence<I...>) {
+    return {{ &GB_CPU::opCB<static_cast<uint8_t>(I)>... }};
 }
 
 void GB_CPU::execute(uint8_t opcode) {
-    switch (opcode) {
-        case 0x00: addCycles(4); break; //NOP
+    (this->*opTable[opcode])();
+}
+
+void GB_CPU::executeCB(uint8_t opcode) {
+    (this->*cbTable[opcode])();
+}
+
+// ============================================================================
+// Helpers registres / opérandes
+// ============================================================================
+// Index de registre 8 bits (bits 0-2 / 3-5 de l'opcode) : B C D E H L (HL) A
+
+template<uint8_t R>
+uint8_t& GB_CPU::reg8() {
+    static_assert(R != 6 && R < 8, "(HL) n'est pas un registre");
+    if constexpr (R == 0) return b;
+    else if constexpr (R == 1) return c;
+    else if constexpr (R == 2) return d;
+    else if constexpr (R == 3) return e;
+    else if constexpr (R == 4) return h;
+    else if constexpr (R == 5) return l;
+    else return a;
+}
+
+// Index de paire 16 bits (bits 4-5) : BC DE HL SP
+template<uint8_t P>
+uint16_t& GB_CPU::reg16() {
+    if constexpr (P == 0) return bc;
+    else if constexpr (P == 1) return de;
+    else if constexpr (P == 2) return hl;
+    else return sp;
+}
 
-    case 0x10:  // STOP
-        pc++;
-        // On peut ignorer STOP pour les tests
+// Opérande source : registre, (HL) ou immédiat
+template<uint8_t R>
+uint8_t GB_CPU::operand() {
+    if constexpr (R == OPERAND_IMM) return mmu.read(pc++);
+    else if constexpr (R == 6) return mmu.read(hl);
+    else return reg8<R>();
+}
+
+// Conditions : NZ Z NC C
+template<uint8_t CC>
+bool GB_CPU::condition() const {
+    if constexpr (CC == 0) return !getFlag(Z_FLAG);
+    else if constexpr (CC == 1) return getFlag(Z_FLAG);
+    else if constexpr (CC == 2) return !getCarry();
+    else return getCarry() != 0;
+}
+
+uint16_t GB_CPU::fetch16() {
+    uint8_t lo = mmu.read(pc++);
+    uint8_t hi = mmu.read(pc++);
+    return (hi << 8) | lo;
+}
+
+void GB_CPU::push16(uint16_t value) {
+    mmu.write(--sp, (value >> 8) & 0xFF);
+    mmu.write(--sp, value & 0xFF);
+}
+
+uint16_t GB_CPU::pop16() {
+    uint8_t lo = mmu.read(sp++);
+    uint8_t hi = mmu.read(sp++);
+    return (hi << 8) | lo;
+}
+
+// ============================================================================
+// Page principale
+// ============================================================================
+
+template<uint8_t OP>
+void GB_CPU::op() {
+    constexpr uint8_t x = OP >> 6;
+    constexpr uint8_t y = (OP >> 3) & 0x07;
+    constexpr uint8_t z = OP & 0x07;
+
+    if constexpr (OP == 0x76) opHALT();
+    else if constexpr (x == 1) opLD<y, z>();
+    else if constexpr (x == 2) opALU<y, z>();
+    else if constexpr (x == 3 && z == 6) opALU<y, OPERAND_IMM>();
+    else if constexpr (x == 0 && z == 4) opINC<y>();
+    else if constexpr (x == 0 && z == 5) opDEC<y>();
+    else if constexpr (x == 0 && z == 6) opLDn<y>();
+    else if constexpr (x == 0 && z == 1 && (y & 1) == 0) { reg16<(y >> 1)>() = fetch16(); addCycles(12); }  // LD rr, nn
+    else if constexpr (x == 0 && z == 1) opADDHL<(y >> 1)>();
+    else if constexpr (x == 0 && z == 3 && (y & 1) == 0) { reg16<(y >> 1)>()++; addCycles(8); }  // INC rr
+    else if constexpr (x == 0 && z == 3) { reg16<(y >> 1)>()--; addCycles(8); }  // DEC rr
+    else if constexpr (OP == 0x18) opJR<4>();
+    else if constexpr (x == 0 && z == 0 && y >= 4) opJR<(y - 4)>();
+    else if constexpr (x == 3 && z == 0 && y < 4) opRET<y>();
+    else if constexpr (x == 3 && z == 2 && y < 4) opJP<y>();
+    else if constexpr (x == 3 && z == 4 && y < 4) opCALL<y>();
+    else if constexpr (x == 3 && z == 5 && (y & 1) == 0) opPUSH<(y >> 1)>();
+    else if constexpr (x == 3 && z == 1 && (y & 1) == 0) opPOP<(y >> 1)>();
+    else if constexpr (x == 3 && z == 7) { push16(pc); pc = y * 8; addCycles(16); }  // RST
+    else opMisc<OP>();
+}
+
+// LD r, r' / LD r, (HL) / LD (HL), r
+template<uint8_t DST, uint8_t SRC>
+void GB_CPU::opLD() {
+    if constexpr (SRC == 6) {
+        reg8<DST>() = mmu.read(hl);
+        addCycles(8);
+    } else if constexpr (DST == 6) {
+        mmu.write(hl, reg8<SRC>());
+        addCycles(8);
+    } else {
+        if constexpr (DST != SRC) reg8<DST>() = reg8<SRC>();
         addCycles(4);
-        break;
-
-        case 0x01: c = mmu.read(pc++); b = mmu.read(pc++); addCycles(12); break;  // LD BC, nn
-        case 0x11: e = mmu.read(pc++); d = mmu.read(pc++); addCycles(12); break;  // LD DE, nn
-        case 0x21: l = mmu.read(pc++); h = mmu.read(pc++); addCycles(12); break;  // LD HL, nn
-        case 0x31: sp = mmu.read(pc++) | (mmu.read(pc++) << 8); addCycles(12); break;  // LD SP, nn
-
-        case 0x06: b = mmu.read(pc++); addCycles(8); break;  // LD B, n
-        case 0x0E: c = mmu.read(pc++); addCycles(8); break;  // LD C, n
-        case 0x16: d = mmu.read(pc++); addCycles(8); break;  // LD D, n
-        case 0x1E: e = mmu.read(pc++); addCycles(8); break;  // LD E, n
-        case 0x26: h = mmu.read(pc++); addCycles(8); break;  // LD H, n
-        case 0x2E: l = mmu.read(pc++); addCycles(8); break;  // LD L, n
-        case 0x3E: a = mmu.read(pc++); addCycles(8); break;  // LD A, n
-
-        case 0x40: addCycles(4); break;  // LD B, B
-        case 0x41: b = c; addCycles(4); break;  // LD B, C
-        case 0x42: b = d; addCycles(4); break;  // LD B, D
-        case 0x43: b = e; addCycles(4); break;  // LD B, E
-        case 0x44: b = h; addCycles(4); break;  // LD B, H
-        case 0x45: b = l; addCycles(4); break;  // LD B, L
-        case 0x46: b = mmu.read(hl); addCycles(8); break;  // LD B, (HL)
-        case 0x47: b = a; addCycles(4); break;  // LD B, A
-
-        case 0x48: c = b; addCycles(4); break;  // LD C, B
-        case 0x49: addCycles(4); break;  // LD C, C
-        case 0x4A: c = d; addCycles(4); break;  // LD C, D
-        case 0x4B: c = e; addCycles(4); break;  // LD C, E
-        case 0x4C: c = h; addCycles(4); break;  // LD C, H
-        case 0x4D: c = l; addCycles(4); break;  // LD C, L
-        case 0x4E: c = mmu.read(hl); addCycles(8); break;  // LD C, (HL)
-        case 0x4F: c = a; addCycles(4); break;  // LD C, A
-
-        case 0x50: d = b; addCycles(4); break;  // LD D, B
-        case 0x51: d = c; addCycles(4); break;  // LD D, C
-        case 0x52: addCycles(4); break;  // LD D, D
-        case 0x53: d = e; addCycles(4); break;  // LD D, E
-        case 0x54: d = h; addCycles(4); break;  // LD D, H
-        case 0x55: d = l; addCycles(4); break;  // LD D, L
-        case 0x56: d = mmu.read(hl); addCycles(8); break;  // LD D, (HL)
-        case 0x57: d = a; addCycles(4); break;  // LD D, A
-
-        case 0x58: e = b; addCycles(4); break;  // LD E, B
-        case 0x59: e = c; addCycles(4); break;  // LD E, C
-        case 0x5A: e = d; addCycles(4); break;  // LD E, D
-        case 0x5B: addCycles(4); break;  // LD E, E
-        case 0x5C: e = h; addCycles(4); break;  // LD E, H
-        case 0x5D: e = l; addCycles(4); break;  // LD E, L
-        case 0x5E: e = mmu.read(hl); addCycles(8); break;  // LD E, (HL)
-        case 0x5F: e = a; addCycles(4); break;  // LD E, A
-
-        case 0x60: h = b; addCycles(4); break;  // LD H, B
-        case 0x61: h = c; addCycles(4); break;  // LD H, C
-        case 0x62: h = d; addCycles(4); break;  // LD H, D
-        case 0x63: h = e; addCycles(4); break;  // LD H, E
-        case 0x64: addCycles(4); break;  // LD H, H
-        case 0x65: h = l; addCycles(4); break;  // LD H, L
-        case 0x66: h = mmu.read(hl); addCycles(8); break;  // LD H, (HL)
-        case 0x67: h = a; addCycles(4); break;  // LD H, A
-
-        case 0x68: l = b; addCycles(4); break;  // LD L, B
-        case 0x69: l = c; addCycles(4); break;  // LD L, C
-        case 0x6A: l = d; addCycles(4); break;  // LD L, D
-        case 0x6B: l = e; addCycles(4); break;  // LD L, E
-        case 0x6C: l = h; addCycles(4); break;  // LD L, H
-        case 0x6D: addCycles(4); break;  // LD L, L
-        case 0x6E: l = mmu.read(hl); addCycles(8); break;  // LD L, (HL)
-        case 0x6F: l = a; addCycles(4); break;  // LD L, A
-
-        case 0x70: mmu.write(hl, b); addCycles(8); break;  // LD (HL), B
-        case 0x71: mmu.write(hl, c); addCycles(8); break;  // LD (HL), C
-        case 0x72: mmu.write(hl, d); addCycles(8); break;  // LD (HL), D
-        case 0x73: mmu.write(hl, e); addCycles(8); break;  // LD (HL), E
-        case 0x74: mmu.write(hl, h); addCycles(8); break;  // LD (HL), H
-        case 0x75: mmu.write(hl, l); addCycles(8); break;  // LD (HL), L
-        case 0x36: mmu.write(hl, mmu.read(pc++)); addCycles(12); break;  // LD (HL), n
-        case 0x77: mmu.write(hl, a); addCycles(8); break;  // LD (HL), A
-
-        case 0x78: a = b; addCycles(4); break;  // LD A, B
-        case 0x79: a = c; addCycles(4); break;  // LD A, C
-        case 0x7A: a = d; addCycles(4); break;  // LD A, D
-        case 0x7B: a = e; addCycles(4); break;  // LD A, E
-        case 0x7C: a = h; addCycles(4); break;  // LD A, H
-        case 0x7D: a = l; addCycles(4); break;  // LD A, L
-        case 0x7E: a = mmu.read(hl); addCycles(8); break;  // LD A, (HL)
-        case 0x7F: addCycles(4); break;  // LD A, A
+    }
+}
 
-        case 0x0A: a = mmu.read(bc); addCycles(8); break;  // LD A, (BC)
-        case 0x1A: a = mmu.read(de); addCycles(8); break;  // LD A, (DE)
-        case 0xFA: { uint16_t addr = mmu.read(pc++) | (mmu.read(pc++) << 8); a = mmu.read(addr); addCycles(16); } break;  // LD A, (nn)
+// LD r, n / LD (HL), n
+template<uint8_t R>
+void GB_CPU::opLDn() {
+    if constexpr (R == 6) {
+        mmu.write(hl, mmu.read(pc++));
+        addCycles(12);
+    } else {
+        reg8<R>() = mmu.read(pc++);
+        addCycles(8);
+    }
+}
 
-        case 0x02: mmu.write(bc, a); addCycles(8); break;  // LD (BC), A
-        case 0x12: mmu.write(de, a); addCycles(8); break;  // LD (DE), A
-        case 0xEA: { uint16_t addr = mmu.read(pc++) | (mmu.read(pc++) << 8); mmu.write(addr, a); addCycles(16); } break;  // LD (nn), A
+// ADD ADC SUB SBC AND XOR OR CP
+template<uint8_t OPK, uint8_t R>
+void GB_CPU::opALU() {
+    constexpr bool withCarry = (OPK == 1 || OPK == 3);
+    uint8_t val = operand<R>();
 
-        case 0xE0: mmu.write(0xFF00 + mmu.read(pc++), a); addCycles(12); break;  // LDH (n), A
-        case 0xF0: a = mmu.read(0xFF00 + mmu.read(pc++)); addCycles(12); break;  // LDH A, (n)
-        case 0xE2: mmu.write(0xFF00 + c, a); addCycles(8); break;  // LD (C), A
-        case 0xF2: a = mmu.read(0xFF00 + c); addCycles(8); break;  // LD A, (C)
+    if constexpr (withCarry && R == 6) {
+        addCycles(4);  // (HL) prend plus de cycles
+    }
 
-        case 0xF8: {
-            int8_t offset = static_cast<int8_t>(mmu.read(pc++));
-            uint16_t result = sp + offset;
-            hl = result;
-            setFlag(Z_FLAG, false);
-            setFlag(N_FLAG, false);
-            setFlag(H_FLAG, ((sp & 0x0F) + (offset & 0x0F)) > 0x0F);
-            setFlag(C_FLAG, ((sp & 0xFF) + (offset & 0xFF)) > 0xFF);
-            addCycles(12);
-        } break;
+    if constexpr (OPK == 0 || OPK == 1) {
+        uint8_t carry = 0;
+        if constexpr (OPK == 1) carry = getCarry();
+        uint8_t result = a + val + carry;
+        setLazyFlags(FlagOp::Add, a, val, carry, result);
+        a = result;
+    } else if constexpr (OPK == 2 || OPK == 3 || OPK == 7) {
+        uint8_t carry = 0;
+        if constexpr (OPK == 3) carry = getCarry();
+        uint8_t result = a - val - carry;
+        setLazyFlags(FlagOp::Sub, a, val, carry, result);
+        if constexpr (OPK != 7) a = result;  // CP ne garde pas le résultat
+    } else {
+        if constexpr (OPK == 4) a &= val;
+        else if constexpr (OPK == 5) a ^= val;
+        else a |= val;
+        setLazyFlags(OPK == 4 ? FlagOp::And : FlagOp::Or, 0, 0, 0, a);
+    }
 
-    case 0x08:  // LD (nn), SP
-        {
-            uint8_t low = mmu.read(pc++);
-            uint8_t high = mmu.read(pc++);
-            uint16_t addr = (high << 8) | low;
+    if constexpr (withCarry && R == 6) addCycles(4);
+    else addCycles((R == 6 || R == OPERAND_IMM) ? 8 : 4);
+}
 
-            mmu.write(addr, sp & 0xFF);         // Low byte
-            mmu.write(addr + 1, (sp >> 8) & 0xFF);  // High byte
+template<uint8_t R>
+void GB_CPU::opINC() {
+    if constexpr (R == 6) {
+        uint8_t result = mmu.read(hl) + 1;
+        mmu.write(hl, result);
+        setLazyFlags(FlagOp::Inc, 0, 0, getCarry(), result);
+        addCycles(12);
+    } else {
+        uint8_t result = ++reg8<R>();
+        setLazyFlags(FlagOp::Inc, 0, 0, getCarry(), result);
+        addCycles(4);
+    }
+}
 
-            addCycles(20);
-        }
-        break;
-
-        case 0xF9: sp = hl; addCycles(8); break;
-
-        case 0xC5: mmu.write(--sp, b); mmu.write(--sp, c); addCycles(16); break;  // PUSH BC
-        case 0xD5: mmu.write(--sp, d); mmu.write(--sp, e); addCycles(16); break;  // PUSH DE
-        case 0xE5: mmu.write(--sp, h); mmu.write(--sp, l); addCycles(16); break;  // PUSH HL
-        case 0xF5: mmu.write(--sp, a); mmu.write(--sp, f & 0xF0); addCycles(16); break;  // PUSH AF
-
-        case 0xC1: c = mmu.read(sp++); b = mmu.read(sp++); addCycles(12); break;  // POP BC
-        case 0xD1: e = mmu.read(sp++); d = mmu.read(sp++); addCycles(12); break;  // POP DE
-        case 0xE1: l = mmu.read(sp++); h = mmu.read(sp++); addCycles(12); break;  // POP HL
-        case 0xF1: f = mmu.read(sp++) & 0xF0; a = mmu.read(sp++); addCycles(12); break;  // POP AF
-
-        // Add
-        case 0x80: { uint8_t val = b; uint16_t result = a + val; setFlag(Z_FLAG, (result & 0xFF) == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, ((a & 0x0F) + (val & 0x0F)) > 0x0F); setFlag(C_FLAG, result > 0xFF); a = result & 0xFF; addCycles(4); } break;
-        case 0x81: { uint8_t val = c; uint16_t result = a + val; setFlag(Z_FLAG, (result & 0xFF) == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, ((a & 0x0F) + (val & 0x0F)) > 0x0F); setFlag(C_FLAG, result > 0xFF); a = result & 0xFF; addCycles(4); } break;
-        case 0x82: { uint8_t val = d; uint16_t result = a + val; setFlag(Z_FLAG, (result & 0xFF) == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, ((a & 0x0F) + (val & 0x0F)) > 0x0F); setFlag(C_FLAG, result > 0xFF); a = result & 0xFF; addCycles(4); } break;
-        case 0x83: { uint8_t val = e; uint16_t result = a + val; setFlag(Z_FLAG, (result & 0xFF) == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, ((a & 0x0F) + (val & 0x0F)) > 0x0F); setFlag(C_FLAG, result > 0xFF); a = result & 0xFF; addCycles(4); } break;
-        case 0x84: { uint8_t val = h; uint16_t result = a + val; setFlag(Z_FLAG, (result & 0xFF) == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, ((a & 0x0F) + (val & 0x0F)) > 0x0F); setFlag(C_FLAG, result > 0xFF); a = result & 0xFF; addCycles(4); } break;
-        case 0x85: { uint8_t val = l; uint16_t result = a + val; setFlag(Z_FLAG, (result & 0xFF) == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, ((a & 0x0F) + (val & 0x0F)) > 0x0F); setFlag(C_FLAG, result > 0xFF); a = result & 0xFF; addCycles(4); } break;
-        case 0x86: { uint8_t val = mmu.read(hl); uint16_t result = a + val; setFlag(Z_FLAG, (result & 0xFF) == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, ((a & 0x0F) + (val & 0x0F)) > 0x0F); setFlag(C_FLAG, result > 0xFF); a = result & 0xFF; addCycles(8); } break;
-        case 0x87: { uint16_t result = a + a; setFlag(Z_FLAG, (result & 0xFF) == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, ((a & 0x0F) + (a & 0x0F)) > 0x0F); setFlag(C_FLAG, result > 0xFF); a = result & 0xFF; addCycles(4); } break;
-        case 0xC6: { uint8_t val = mmu.read(pc++); uint16_t result = a + val; setFlag(Z_FLAG, (result & 0xFF) == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, ((a & 0x0F) + (val & 0x0F)) > 0x0F); setFlag(C_FLAG, result > 0xFF); a = result & 0xFF; addCycles(8); } break;
-
-        //Inc/Dec 8-bit
-        case 0x04: { uint8_t result = ++b; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, (result & 0x0F) == 0x00); addCycles(4); } break;  // INC B
-        case 0x0C: { uint8_t result = ++c; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, (result & 0x0F) == 0x00); addCycles(4); } break;  // INC C
-        case 0x14: { uint8_t result = ++d; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, (result & 0x0F) == 0x00); addCycles(4); } break;  // INC D
-        case 0x1C: { uint8_t result = ++e; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, (result & 0x0F) == 0x00); addCycles(4); } break;  // INC E
-        case 0x24: { uint8_t result = ++h; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, (result & 0x0F) == 0x00); addCycles(4); } break;  // INC H
-        case 0x2C: { uint8_t result = ++l; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, (result & 0x0F) == 0x00); addCycles(4); } break;  // INC L
-        case 0x3C: { uint8_t result = ++a; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, (result & 0x0F) == 0x00); addCycles(4); } break;  // INC A
-
-        case 0x05: { uint8_t result = --b; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (result & 0x0F) == 0x0F); addCycles(4); } break;  // DEC B
-        case 0x0D: { uint8_t result = --c; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (result & 0x0F) == 0x0F); addCycles(4); } break;  // DEC C
-        case 0x15: { uint8_t result = --d; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (result & 0x0F) == 0x0F); addCycles(4); } break;  // DEC D
-        case 0x1D: { uint8_t result = --e; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (result & 0x0F) == 0x0F); addCycles(4); } break;  // DEC E
-        case 0x25: { uint8_t result = --h; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (result & 0x0F) == 0x0F); addCycles(4); } break;  // DEC H
-        case 0x2D: { uint8_t result = --l; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (result & 0x0F) == 0x0F); addCycles(4); } break;  // DEC L
-        case 0x3D: { uint8_t result = --a; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (result & 0x0F) == 0x0F); addCycles(4); } break;  // DEC A
-
-        //Inc/Dec 16 bit
-        case 0x03: bc++; addCycles(8); break;  // INC BC
-        case 0x13: de++; addCycles(8); break;  // INC DE
-        case 0x23: hl++; addCycles(8); break;  // INC HL
-        case 0x33: sp++; addCycles(8); break;  // INC SP
-
-        case 0x0B: bc--; addCycles(8); break;  // DEC BC
-        case 0x1B: de--; addCycles(8); break;  // DEC DE
-        case 0x2B: hl--; addCycles(8); break;  // DEC HL
-        case 0x3B: sp--; addCycles(8); break;  // DEC SP
-
-        //add with carry
-    case 0xCE:  // ADC A, n
-        {
-            uint8_t val = mmu.read(pc++);
-            int carry = getFlag(C_FLAG) ? 1 : 0;
-            int result = a + val + carry;
-
-            setFlag(Z_FLAG, (result & 0xFF) == 0);
-            setFlag(N_FLAG, false);
-            setFlag(H_FLAG, ((a & 0x0F) + (val & 0x0F) + carry) > 0x0F);
-            setFlag(C_FLAG, result > 0xFF);
-
-            a = result & 0xFF;
-            addCycles(8);
-        }
-        break;
-    case 0x88: case 0x89: case 0x8A: case 0x8B:
-    case 0x8C: case 0x8D: case 0x8E: case 0x8F:
-        {
-            uint8_t val = 0;
-            switch (opcode & 0x07) {
-            case 0: val = b; break;
-            case 1: val = c; break;
-            case 2: val = d; break;
-            case 3: val = e; break;
-            case 4: val = h; break;
-            case 5: val = l; break;
-            case 6: val = mmu.read(hl); addCycles(4); break;
-            case 7: val = a; break;
-            }
+template<uint8_t R>
+void GB_CPU::opDEC() {
+    if constexpr (R == 6) {
+        uint8_t result = mmu.read(hl) - 1;
+        mmu.write(hl, result);
+        setLazyFlags(FlagOp::Dec, 0, 0, getCarry(), result);
+        addCycles(12);
+    } else {
+        uint8_t result = --reg8<R>();
+        setLazyFlags(FlagOp::Dec, 0, 0, getCarry(), result);
+        addCycles(4);
+    }
+}
 
-            int carry = getFlag(C_FLAG) ? 1 : 0;
-            int result = a + val + carry;
+// ADD HL, rr
+template<uint8_t P>
+void GB_CPU::opADDHL() {
+    uint16_t val = reg16<P>();
+    uint32_t result = hl + val;
+    setFlag(N_FLAG, false);
+    setFlag(H_FLAG, ((hl & 0x0FFF) + (val & 0x0FFF)) > 0x0FFF);
+    setFlag(C_FLAG, result > 0xFFFF);
+    hl = result & 0xFFFF;
+    addCycles(8);
+}
 
-            setFlag(Z_FLAG, (result & 0xFF) == 0);
-            setFlag(N_FLAG, false);
-            setFlag(H_FLAG, ((a & 0x0F) + (val & 0x0F) + carry) > 0x0F);
-            setFlag(C_FLAG, result > 0xFF);
+// JR n / JR cc, n (CC == 4 : inconditionnel)
+template<uint8_t CC>
+void GB_CPU::opJR() {
+    int8_t offset = static_cast<int8_t>(mmu.read(pc++));
+    bool taken = true;
+    if constexpr (CC != 4) taken = condition<CC>();
+
+    if (taken) {
+        uint16_t branchPC = pc - 2;
+        pc += offset;
+        addCycles(12);
+        if (pc <= branchPC) checkIdleLoop(branchPC);
+    } else {
+        addCycles(8);
+    }
+}
 
-            a = result & 0xFF;
-            addCycles(4);
-        }
-        break;
-
-        //sub with carry
-    case 0xDE:  // SBC A, n
-        {
-            uint8_t val = mmu.read(pc++);
-            int carry = getFlag(C_FLAG) ? 1 : 0;
-            int result = a - val - carry;
-
-            setFlag(Z_FLAG, (result & 0xFF) == 0);
-            setFlag(N_FLAG, true);
-            setFlag(H_FLAG, ((a & 0x0F) - (val & 0x0F) - carry) < 0);
-            setFlag(C_FLAG, result < 0);
-
-            a = result & 0xFF;
-            addCycles(8);
-        }
-        break;
-        // SBC A, r (Subtract with Carry)
-    case 0x98: case 0x99: case 0x9A: case 0x9B:
-    case 0x9C: case 0x9D: case 0x9E: case 0x9F:
-        {
-            uint8_t val = 0;
-            switch (opcode & 0x07) {
-            case 0: val = b; break;
-            case 1: val = c; break;
-            case 2: val = d; break;
-            case 3: val = e; break;
-            case 4: val = h; break;
-            case 5: val = l; break;
-            case 6: val = mmu.read(hl); addCycles(4); break;
-            case 7: val = a; break;
-            }
+template<uint8_t CC>
+void GB_CPU::opJP() {
+    uint16_t addr = fetch16();
+    if (condition<CC>()) {
+        uint16_t branchPC = pc - 3;
+        pc = addr;
+        addCycles(16);
+        if (pc <= branchPC) checkIdleLoop(branchPC);
+    } else {
+        addCycles(12);
+    }
+}
+
+template<uint8_t CC>
+void GB_CPU::opCALL() {
+    uint16_t addr = fetch16();
+    if (condition<CC>()) {
+        push16(pc);
+        pc = addr;
+        addCycles(24);
+    } else {
+        addCycles(12);
+    }
+}
+
+template<uint8_t CC>
+void GB_CPU::opRET() {
+    if (condition<CC>()) {
+        pc = pop16();
+        addCycles(20);
+    } else {
+        addCycles(8);
+    }
+}
 
-            int carry = getFlag(C_FLAG) ? 1 : 0;
-            int result = a - val - carry;
+template<uint8_t P>
+void GB_CPU::opPUSH() {
+    if constexpr (P == 3) {
+        mmu.write(--sp, a);
+        mmu.write(--sp, getF());
+    } else {
+        push16(reg16<P>());
+    }
+    addCycles(16);
+}
 
-            setFlag(Z_FLAG, (result & 0xFF) == 0);
-            setFlag(N_FLAG, true);
-            setFlag(H_FLAG, ((a & 0x0F) - (val & 0x0F) - carry) < 0);
-            setFlag(C_FLAG, result < 0);
+template<uint8_t P>
+void GB_CPU::opPOP() {
+    if constexpr (P == 3) {
+        f = mmu.read(sp++) & 0xF0;
+        a = mmu.read(sp++);
+        lazy.op = FlagOp::None;
+    } else {
+        reg16<P>() = pop16();
+    }
+    addCycles(12);
+}
 
-            a = result & 0xFF;
+void GB_CPU::opHALT() {
+    if (ime == false && interrupts.getPending()) {
+        // LE BUG : Le CPU ne s'arrête pas, mais le PC ne s'incrémente pas
+        // lors de la lecture de l'opcode suivant (on lit deux fois le même)
+        haltBugTriggered = true;
+    } else {
+        halted = true;
+    }
+}
+
+// Opcodes sans motif régulier. OP est constant : le switch est résolu à la compilation.
+template<uint8_t OP>
+void GB_CPU::opMisc() {
+    switch (OP) {
+        case 0x00: addCycles(4); break;  // NOP
+
+        case 0x10:  // STOP
+            pc++;
+            // On peut ignorer STOP pour les tests
             addCycles(4);
-        }
-        break;
-        //Xor
-        case 0xA8: a ^= b; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xA9: a ^= c; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xAA: a ^= d; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xAB: a ^= e; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xAC: a ^= h; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xAD: a ^= l; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xAE: a ^= mmu.read(hl); setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(8); break;
-        case 0xAF: a = 0; setFlag(Z_FLAG, true); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;  // XOR A
-        case 0xEE: { uint8_t val = mmu.read(pc++); a ^= val; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(8); } break;  // XOR n
-
-        case 0xB8: { uint8_t result = a - b; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (b & 0x0F)); setFlag(C_FLAG, a < b); addCycles(4); } break;
-        case 0xB9: { uint8_t result = a - c; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (c & 0x0F)); setFlag(C_FLAG, a < c); addCycles(4); } break;
-        case 0xFE: { uint8_t val = mmu.read(pc++); uint8_t result = a - val; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (val & 0x0F)); setFlag(C_FLAG, a < val); addCycles(8); } break;  // CP n
-
-        case 0x18: { int8_t offset = static_cast<int8_t>(mmu.read(pc++)); pc += offset; addCycles(12); } break;  // JR n
-        case 0x20: { int8_t offset = static_cast<int8_t>(mmu.read(pc++)); if (!getFlag(Z_FLAG)) { pc += offset; addCycles(12); } else { addCycles(8); } } break;  // JR NZ, n
-        case 0x28: { int8_t offset = static_cast<int8_t>(mmu.read(pc++)); if (getFlag(Z_FLAG)) { pc += offset; addCycles(12); } else { addCycles(8); } } break;  // JR Z, n
-        case 0x30: { int8_t offset = static_cast<int8_t>(mmu.read(pc++)); if (!getFlag(C_FLAG)) { pc += offset; addCycles(12); } else { addCycles(8); } } break;  // JR NC, n
-        case 0x38: { int8_t offset = static_cast<int8_t>(mmu.read(pc++)); if (getFlag(C_FLAG)) { pc += offset; addCycles(12); } else { addCycles(8); } } break;  // JR C, n
-
-        //
-        case 0x22: mmu.write(hl++, a); addCycles(8); break;  // LD (HL+), A
-        case 0x2A: a = mmu.read(hl++); addCycles(8); break;  // LD A, (HL+)
-        case 0x32: mmu.write(hl--, a); addCycles(8); break;  // LD (HL-), A
-        case 0x3A: a = mmu.read(hl--); addCycles(8); break;  // LD A, (HL-)
+            break;
 
-        // ====================================================================
-        // SUB (subtract)
-        // ====================================================================
-        case 0x90: { uint8_t result = a - b; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (b & 0x0F)); setFlag(C_FLAG, a < b); a = result; addCycles(4); } break;
-        case 0x91: { uint8_t result = a - c; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (c & 0x0F)); setFlag(C_FLAG, a < c); a = result; addCycles(4); } break;
-        case 0x92: { uint8_t result = a - d; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (d & 0x0F)); setFlag(C_FLAG, a < d); a = result; addCycles(4); } break;
-        case 0x93: { uint8_t result = a - e; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (e & 0x0F)); setFlag(C_FLAG, a < e); a = result; addCycles(4); } break;
-        case 0x94: { uint8_t result = a - h; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (h & 0x0F)); setFlag(C_FLAG, a < h); a = result; addCycles(4); } break;
-        case 0x95: { uint8_t result = a - l; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (l & 0x0F)); setFlag(C_FLAG, a < l); a = result; addCycles(4); } break;
-        case 0x96: { uint8_t val = mmu.read(hl); uint8_t result = a - val; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (val & 0x0F)); setFlag(C_FLAG, a < val); a = result; addCycles(8); } break;
-        case 0x97: a = 0; setFlag(Z_FLAG, true); setFlag(N_FLAG, true); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;  // SUB A
-        case 0xD6: { uint8_t val = mmu.read(pc++); uint8_t result = a - val; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (val & 0x0F)); setFlag(C_FLAG, a < val); a = result; addCycles(8); } break;  // SUB n
+        case 0x0A: a = mmu.read(bc); addCycles(8); break;  // LD A, (BC)
+        case 0x1A: a = mmu.read(de); addCycles(8); break;  // LD A, (DE)
+        case 0xFA: a = mmu.read(fetch16()); addCycles(16); break;  // LD A, (nn)
 
-        // ====================================================================
-        // AND
-        // ====================================================================
-        case 0xA0: a &= b; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, true); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xA1: a &= c; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, true); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xA2: a &= d; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, true); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xA3: a &= e; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, true); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xA4: a &= h; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, true); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xA5: a &= l; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, true); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xA6: a &= mmu.read(hl); setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, true); setFlag(C_FLAG, false); addCycles(8); break;
-        case 0xA7: setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, true); setFlag(C_FLAG, false); addCycles(4); break;  // AND A
-        case 0xE6: { uint8_t val = mmu.read(pc++); a &= val; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, true); setFlag(C_FLAG, false); addCycles(8); } break;  // AND n
+        case 0x02: mmu.write(bc, a); addCycles(8); break;  // LD (BC), A
+        case 0x12: mmu.write(de, a); addCycles(8); break;  // LD (DE), A
+        case 0xEA: mmu.write(fetch16(), a); addCycles(16); break;  // LD (nn), A
 
-        // ====================================================================
-        // OR
-        // ====================================================================
-        case 0xB0: a |= b; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xB1: a |= c; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xB2: a |= d; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xB3: a |= e; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xB4: a |= h; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xB5: a |= l; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;
-        case 0xB6: a |= mmu.read(hl); setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(8); break;
-        case 0xB7: setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;  // OR A
-        case 0xF6: { uint8_t val = mmu.read(pc++); a |= val; setFlag(Z_FLAG, a == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(8); } break;  // OR n
+        case 0xE0: mmu.write(0xFF00 + mmu.read(pc++), a); addCycles(12); break;  // LDH (n), A
+        case 0xF0: a = mmu.read(0xFF00 + mmu.read(pc++)); addCycles(12); break;  // LDH A, (n)
+        case 0xE2: mmu.write(0xFF00 + c, a); addCycles(8); break;  // LD (C), A
+        case 0xF2: a = mmu.read(0xFF00 + c); addCycles(8); break;  // LD A, (C)
 
-        // ====================================================================
-        // CP (plus de variantes)
-        // ====================================================================
-        case 0xBA: { uint8_t result = a - d; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (d & 0x0F)); setFlag(C_FLAG, a < d); addCycles(4); } break;
-        case 0xBB: { uint8_t result = a - e; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (e & 0x0F)); setFlag(C_FLAG, a < e); addCycles(4); } break;
-        case 0xBC: { uint8_t result = a - h; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (h & 0x0F)); setFlag(C_FLAG, a < h); addCycles(4); } break;
-        case 0xBD: { uint8_t result = a - l; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (l & 0x0F)); setFlag(C_FLAG, a < l); addCycles(4); } break;
-        case 0xBE: { uint8_t val = mmu.read(hl); uint8_t result = a - val; setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (a & 0x0F) < (val & 0x0F)); setFlag(C_FLAG, a < val); addCycles(8); } break;
-        case 0xBF: setFlag(Z_FLAG, true); setFlag(N_FLAG, true); setFlag(H_FLAG, false); setFlag(C_FLAG, false); addCycles(4); break;  // CP A
+        case 0x22: mmu.write(hl++, a); addCycles(8); break;  // LD (HL+), A
+        case 0x2A: a = mmu.read(hl++); addCycles(8); break;  // LD A, (HL+)
+        case 0x32: mmu.write(hl--, a); addCycles(8); break;  // LD (HL-), A
+        case 0x3A: a = mmu.read(hl--); addCycles(8); break;  // LD A, (HL-)
 
-        // ====================================================================
-        // RST (restart - appels de fonction fixes)
-        // ====================================================================
-        case 0xC7: mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = 0x0000; addCycles(16); break;  // RST 00H
-        case 0xCF: mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = 0x0008; addCycles(16); break;  // RST 08H
-        case 0xD7: mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = 0x0010; addCycles(16); break;  // RST 10H
-        case 0xDF: mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = 0x0018; addCycles(16); break;  // RST 18H
-        case 0xE7: mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = 0x0020; addCycles(16); break;  // RST 20H
-        case 0xEF: mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = 0x0028; addCycles(16); break;  // RST 28H
-        case 0xF7: mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = 0x0030; addCycles(16); break;  // RST 30H
-        case 0xFF: mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = 0x0038; addCycles(16); break;  // RST 38H
+        case 0x08: {  // LD (nn), SP
+            uint16_t addr = fetch16();
+            mmu.write(addr, sp & 0xFF);             // Low byte
+            mmu.write(addr + 1, (sp >> 8) & 0xFF);  // High byte
+            addCycles(20);
+        } break;
 
-        // ====================================================================
-        // RET variants
-        // ====================================================================
-        case 0xD0: { if (!getFlag(C_FLAG)) { uint8_t lo = mmu.read(sp++); uint8_t hi = mmu.read(sp++); pc = (hi << 8) | lo; addCycles(20); } else { addCycles(8); } } break;  // RET NC
-        case 0xD8: { if (getFlag(C_FLAG)) { uint8_t lo = mmu.read(sp++); uint8_t hi = mmu.read(sp++); pc = (hi << 8) | lo; addCycles(20); } else { addCycles(8); } } break;  // RET C
-        case 0xD9:  // RETI
-            {
-                uint8_t lo = mmu.read(sp++);
-                uint8_t hi = mmu.read(sp++);
-                pc = (hi << 8) | lo;
-                ime = true;
-                //imeScheduled = false;
+        case 0xF8:  // LD HL, SP+n
+        case 0xE8: {  // ADD SP, n
+            int8_t offset = static_cast<int8_t>(mmu.read(pc++));
+            uint16_t result = sp + offset;
+            setFlags(false, false,
+                     ((sp & 0x0F) + (offset & 0x0F)) > 0x0F,
+                     ((sp & 0xFF) + (offset & 0xFF)) > 0xFF);
+            if (OP == 0xF8) {
+                hl = result;
+                addCycles(12);
+            } else {
+                sp = result;
                 addCycles(16);
             }
-            break;
+        } break;
 
-        // ====================================================================
-        // JP variants (plus complets)
-        // ====================================================================
-        case 0xD2: { uint16_t addr = mmu.read(pc++) | (mmu.read(pc++) << 8); if (!getFlag(C_FLAG)) { pc = addr; addCycles(16); } else { addCycles(12); } } break;  // JP NC, nn
-        case 0xDA: { uint16_t addr = mmu.read(pc++) | (mmu.read(pc++) << 8); if (getFlag(C_FLAG)) { pc = addr; addCycles(16); } else { addCycles(12); } } break;  // JP C, nn
-
-        // ====================================================================
-        // CALL variants
-        // ====================================================================
-        case 0xD4: { uint16_t addr = mmu.read(pc++) | (mmu.read(pc++) << 8); if (!getFlag(C_FLAG)) { mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = addr; addCycles(24); } else { addCycles(12); } } break;  // CALL NC, nn
-        case 0xDC: { uint16_t addr = mmu.read(pc++) | (mmu.read(pc++) << 8); if (getFlag(C_FLAG)) { mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = addr; addCycles(24); } else { addCycles(12); } } break;  // CALL C, nn
+        case 0xF9: sp = hl; addCycles(8); break;  // LD SP, HL
 
         // ====================================================================
         // Rotation (RLCA, RRCA, RLA, RRA)
         // ====================================================================
-        case 0x07: { uint8_t carry = (a & 0x80) >> 7; a = (a << 1) | carry; setFlag(Z_FLAG, false); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, carry != 0); addCycles(4); } break;  // RLCA
-        case 0x0F: { uint8_t carry = a & 0x01; a = (a >> 1) | (carry << 7); setFlag(Z_FLAG, false); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, carry != 0); addCycles(4); } break;  // RRCA
-        case 0x17: { uint8_t carry = getFlag(C_FLAG) ? 1 : 0; uint8_t newCarry = (a & 0x80) >> 7; a = (a << 1) | carry; setFlag(Z_FLAG, false); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, newCarry != 0); addCycles(4); } break;  // RLA
-        case 0x1F: { uint8_t carry = getFlag(C_FLAG) ? 1 : 0; uint8_t newCarry = a & 0x01; a = (a >> 1) | (carry << 7); setFlag(Z_FLAG, false); setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, newCarry != 0); addCycles(4); } break;  // RRA
+        case 0x07: { uint8_t carry = (a & 0x80) >> 7; a = (a << 1) | carry; setFlags(false, false, false, carry != 0); addCycles(4); } break;  // RLCA
+        case 0x0F: { uint8_t carry = a & 0x01; a = (a >> 1) | (carry << 7); setFlags(false, false, false, carry != 0); addCycles(4); } break;  // RRCA
+        case 0x17: { uint8_t carry = getCarry(); uint8_t newCarry = (a & 0x80) >> 7; a = (a << 1) | carry; setFlags(false, false, false, newCarry != 0); addCycles(4); } break;  // RLA
+        case 0x1F: { uint8_t carry = getCarry(); uint8_t newCarry = a & 0x01; a = (a >> 1) | (carry << 7); setFlags(false, false, false, newCarry != 0); addCycles(4); } break;  // RRA
 
         // ====================================================================
         // DAA (Decimal Adjust Accumulator)
         // ====================================================================
         case 0x27: {
+            materializeFlags();
             uint16_t temp = a;
             if (!getFlag(N_FLAG)) {
                 if (getFlag(H_FLAG) || (temp & 0x0F) > 9) temp += 0x06;
@@ -477,101 +522,53 @@ void GB_CPU::execute(uint8_t opcode) {
         case 0x3F: setFlag(N_FLAG, false); setFlag(H_FLAG, false); setFlag(C_FLAG, !getFlag(C_FLAG)); addCycles(4); break;  // CCF
 
         // ====================================================================
-        // INC/DEC (HL)
-        // ====================================================================
-        case 0x34: { uint8_t val = mmu.read(hl); uint8_t result = val + 1; mmu.write(hl, result); setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, false); setFlag(H_FLAG, (result & 0x0F) == 0x00); addCycles(12); } break;  // INC (HL)
-        case 0x35: { uint8_t val = mmu.read(hl); uint8_t result = val - 1; mmu.write(hl, result); setFlag(Z_FLAG, result == 0); setFlag(N_FLAG, true); setFlag(H_FLAG, (result & 0x0F) == 0x0F); addCycles(12); } break;  // DEC (HL)
-
-        // ====================================================================
-        // ADD HL, rr (16-bit addition)
-        // ====================================================================
-        case 0x09: { uint32_t result = hl + bc; setFlag(N_FLAG, false); setFlag(H_FLAG, ((hl & 0x0FFF) + (bc & 0x0FFF)) > 0x0FFF); setFlag(C_FLAG, result > 0xFFFF); hl = result & 0xFFFF; addCycles(8); } break;  // ADD HL, BC
-        case 0x19: { uint32_t result = hl + de; setFlag(N_FLAG, false); setFlag(H_FLAG, ((hl & 0x0FFF) + (de & 0x0FFF)) > 0x0FFF); setFlag(C_FLAG, result > 0xFFFF); hl = result & 0xFFFF; addCycles(8); } break;  // ADD HL, DE
-        case 0x29: { uint32_t result = hl + hl; setFlag(N_FLAG, false); setFlag(H_FLAG, ((hl & 0x0FFF) + (hl & 0x0FFF)) > 0x0FFF); setFlag(C_FLAG, result > 0xFFFF); hl = result & 0xFFFF; addCycles(8); } break;  // ADD HL, HL
-        case 0x39: { uint32_t result = hl + sp; setFlag(N_FLAG, false); setFlag(H_FLAG, ((hl & 0x0FFF) + (sp & 0x0FFF)) > 0x0FFF); setFlag(C_FLAG, result > 0xFFFF); hl = result & 0xFFFF; addCycles(8); } break;  // ADD HL, SP
-
-        // ====================================================================
-        // ADD SP, n
+        // Sauts / appels inconditionnels
         // ====================================================================
-        case 0xE8: {
-            int8_t offset = static_cast<int8_t>(mmu.read(pc++));
-            uint16_t result = sp + offset;
-            setFlag(Z_FLAG, false);
-            setFlag(N_FLAG, false);
-            setFlag(H_FLAG, ((sp & 0x0F) + (offset & 0x0F)) > 0x0F);
-            setFlag(C_FLAG, ((sp & 0xFF) + (offset & 0xFF)) > 0xFF);
-            sp = result;
+        case 0xC3: {  // JP nn
+            uint16_t branchPC = pc - 1;
+            pc = fetch16();
             addCycles(16);
+            if (pc <= branchPC) checkIdleLoop(branchPC);
         } break;
-        //
-        case 0xC3: pc = mmu.read(pc) | (mmu.read(pc + 1) << 8); addCycles(16); break;  // JP nn
-        case 0xC2: { uint16_t addr = mmu.read(pc++) | (mmu.read(pc++) << 8); if (!getFlag(Z_FLAG)) { pc = addr; addCycles(16); } else { addCycles(12); } } break;  // JP NZ, nn
-        case 0xCA: { uint16_t addr = mmu.read(pc++) | (mmu.read(pc++) << 8); if (getFlag(Z_FLAG)) { pc = addr; addCycles(16); } else { addCycles(12); } } break;  // JP Z, nn
         case 0xE9: pc = hl; addCycles(4); break;  // JP (HL)
-
-        case 0xCD: { uint16_t addr = mmu.read(pc++) | (mmu.read(pc++) << 8); mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = addr; addCycles(24); } break;  // CALL nn
-        case 0xC4: { uint16_t addr = mmu.read(pc++) | (mmu.read(pc++) << 8); if (!getFlag(Z_FLAG)) { mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = addr; addCycles(24); } else { addCycles(12); } } break;  // CALL NZ, nn
-        case 0xCC: { uint16_t addr = mmu.read(pc++) | (mmu.read(pc++) << 8); if (getFlag(Z_FLAG)) { mmu.write(--sp, (pc >> 8) & 0xFF); mmu.write(--sp, pc & 0xFF); pc = addr; addCycles(24); } else { addCycles(12); } } break;  // CALL Z, nn
-
-        case 0xC9: { uint8_t lo = mmu.read(sp++); uint8_t hi = mmu.read(sp++); pc = (hi << 8) | lo; addCycles(16); } break;  // RET
-        case 0xC0: { if (!getFlag(Z_FLAG)) { uint8_t lo = mmu.read(sp++); uint8_t hi = mmu.read(sp++); pc = (hi << 8) | lo; addCycles(20); } else { addCycles(8); } } break;  // RET NZ
-        case 0xC8: { if (getFlag(Z_FLAG)) { uint8_t lo = mmu.read(sp++); uint8_t hi = mmu.read(sp++); pc = (hi << 8) | lo; addCycles(20); } else { addCycles(8); } } break;  // RET Z
-
-        case 0x76: // HALT
-            if (ime == false && (mmu.read(0xFF0F) & mmu.read(0xFFFF) & 0x1F) != 0) {
-                // LE BUG : Le CPU ne s'arrête pas, mais le PC ne s'incrémente pas
-                // lors de la lecture de l'opcode suivant (on lit deux fois le même)
-                haltBugTriggered = true;
-            } else {
-                halted = true;
-            }
+        case 0xCD: { uint16_t addr = fetch16(); push16(pc); pc = addr; addCycles(24); } break;  // CALL nn
+        case 0xC9: pc = pop16(); addCycles(16); break;  // RET
+        case 0xD9:  // RETI
+            pc = pop16();
+            ime = true;
+            //imeScheduled = false;
+            addCycles(16);
             break;
-        case 0xF3: ime = false; imeScheduled = false;addCycles(4); break;  // DI
+
+        case 0xF3: ime = false; imeScheduled = false; addCycles(4); break;  // DI
         case 0xFB: imeScheduled = true; addCycles(4); break;  // EI
 
-        case 0xCB: {
-            uint8_t cb_opcode = mmu.read(pc++);
-            executeCB(cb_opcode);
-        } break;
+        case 0xCB: executeCB(mmu.read(pc++)); break;
 
         default:
-            LOG_ERROR("Unimplemented opcode: {:#04x} at PC: {:#06x}", opcode, pc - 1);
+            LOG_ERROR("Unimplemented opcode: {:#04x} at PC: {:#06x}", OP, pc - 1);
             addCycles(4);
             break;
     }
 }
 
-void GB_CPU::executeCB(uint8_t opcode) {
-    uint8_t bit = (opcode >> 3) & 0x07;   // Bits 3-5
-    uint8_t reg = opcode & 0x07;          // Bits 0-2
-
-    // Helper pour lire/écrire les registres
-    auto getRegister = [&](uint8_t r) -> uint8_t& {
-        switch (r) {
-            case 0: return b;
-            case 1: return c;
-            case 2: return d;
-            case 3: return e;
-            case 4: return h;
-            case 5: return l;
-            case 7: return a;
-            default: {
-                static uint8_t dummy = 0;
-                return dummy;
-            }
-        }
-    };
+// ============================================================================
+// Page CB
+// ============================================================================
+
+template<uint8_t OP>
+void GB_CPU::opCB() {
+    constexpr uint8_t x = OP >> 6;
+    constexpr uint8_t bit = (OP >> 3) & 0x07;   // Bits 3-5
+    constexpr uint8_t reg = OP & 0x07;          // Bits 0-2
 
     // ====================================================================
     // BIT b, r (test bit)
     // ====================================================================
-    if ((opcode & 0xC0) == 0x40) {
-        uint8_t val = 0;
-        if (reg == 6) {
-            val = mmu.read(hl);
+    if constexpr (x == 1) {
+        uint8_t val = operand<reg>();
+        if constexpr (reg == 6) {
             addCycles(4);  // (HL) prend plus de cycles
-        } else {
-            val = getRegister(reg);
         }
 
         setFlag(Z_FLAG, (val & (1 << bit)) == 0);
@@ -582,186 +579,561 @@ void GB_CPU::executeCB(uint8_t opcode) {
     }
 
     // ====================================================================
-    // RES b, r (reset bit)
+    // RES b, r / SET b, r / ROTATIONS & SHIFTS
     // ====================================================================
-    if ((opcode & 0xC0) == 0x80) {
-        if (reg == 6) {
-            uint8_t val = mmu.read(hl);
-            val &= ~(1 << bit);
-            mmu.write(hl, val);
-            addCycles(16);
-        } else {
-            getRegister(reg) &= ~(1 << bit);
-            addCycles(8);
+    uint8_t val = operand<reg>();
+
+    if constexpr (x == 2) {
+        val &= ~(1 << bit);
+    } else if constexpr (x == 3) {
+        val |= (1 << bit);
+    } else {
+        val = rotate<bit>(val);
+    }
+
+    if constexpr (reg == 6) {
+        mmu.write(hl, val);
+        addCycles(16);
+    } else {
+        reg8<reg>() = val;
+        addCycles(8);
+    }
+}
+
+// RLC RRC RL RR SLA SRA SWAP SRL
+template<uint8_t OPK>
+uint8_t GB_CPU::rotate(uint8_t val) {
+    uint8_t carry = 0;
+
+    if constexpr (OPK == 0) {  // RLC (rotate left circular)
+        carry = (val & 0x80) >> 7;
+        val = (val << 1) | carry;
+    } else if constexpr (OPK == 1) {  // RRC (rotate right circular)
+        carry = val & 0x01;
+        val = (val >> 1) | (carry << 7);
+    } else if constexpr (OPK == 2) {  // RL (rotate left through carry)
+        uint8_t oldCarry = getCarry();
+        carry = (val & 0x80) >> 7;
+        val = (val << 1) | oldCarry;
+    } else if constexpr (OPK == 3) {  // RR (rotate right through carry)
+        uint8_t oldCarry = getCarry();
+        carry = val & 0x01;
+        val = (val >> 1) | (oldCarry << 7);
+    } else if constexpr (OPK == 4) {  // SLA (shift left arithmetic)
+        carry = (val & 0x80) >> 7;
+        val = val << 1;
+    } else if constexpr (OPK == 5) {  // SRA (shift right arithmetic - preserve sign bit)
+        carry = val & 0x01;
+        val = (val >> 1) | (val & 0x80);
+    } else if constexpr (OPK == 6) {  // SWAP (swap nibbles)
+        val = ((val & 0x0F) << 4) | ((val & 0xF0) >> 4);
+    } else {  // SRL (shift right logical)
+        carry = val & 0x01;
+        val = val >> 1;
+    }
+
+    setFlags(val == 0, false, false, carry != 0);
+    return val;
+}
+
+const std::array<GB_CPU::OpHandler, 256> GB_CPU::opTable = GB_CPU::makeOpTable(std::make_index_sequence<256>{});
+const std::array<GB_CPU::OpHandler, 256> GB_CPU::cbTable = GB_CPU::makeCBTable(std::make_index_sequence<256>{});
+
+#ifdef GB_JIT_ENABLED
+template<uint8_t OP, bool CB>
+uint32_t GB_CPU::jitOp(GB_CPU* cpu, uint32_t next, uint32_t cycles) {
+    // Même séquence que executeBlock ; le budget du bloc natif garantit
+    // qu'aucun événement ne tombe avant la fin de l'instruction
+    cpu->pc = static_cast<uint16_t>(next);
+    cpu->addCycles(static_cast<int>(cycles));
+    if constexpr (CB) cpu->opCB<OP>();
+    else cpu->op<OP>();
+    return cpu->jitMustStop() ? 1 : 0;
+}
+
+template<bool CB, std::size_t... I>
+constexpr std::array<GB_CPU::JitHandler, 256> GB_CPU::makeJitTable(std::index_sequence<I...>) {
+    return {{ &GB_CPU::jitOp<static_cast<uint8_t>(I), CB>... }};
+}
+
+const std::array<GB_CPU::JitHandler, 256> GB_CPU::jitOpTable = GB_CPU::makeJitTable<false>(std::make_index_sequence<256>{});
+const std::array<GB_CPU::JitHandler, 256> GB_CPU::jitCBTable = GB_CPU::makeJitTable<true>(std::make_index_sequence<256>{});
+#endif
+
+int GB_CPU::haltSkipCycles() const {
+    uint64_t next = scheduler.nextEventTime();
+    uint64_t now = scheduler.now();
+
+    if (next <= now) return 4;
+
+    uint64_t delta = next - now;
+    if (delta > MAX_HALT_SKIP) delta = MAX_HALT_SKIP;  // Rien de planifié (LCD et timer off)
+
+    // Arrondi au M-cycle supérieur
+    return static_cast<int>((delta + 3) & ~3ULL);
+}
+
+void GB_CPU::checkIdleLoop(uint16_t branchPC) {
+    if (static_cast<uint16_t>(branchPC - pc) > MAX_IDLE_LOOP_BYTES) return;
+
+    const uint64_t now = scheduler.now();
+    const uint64_t next = scheduler.nextEventTime();
+    const uint64_t length = now - idleLoop.lastTime;
+    const std::array<uint16_t, 5> regs = { getAF(), bc, de, hl, sp };
+
+    const bool sameLoop = idleLoop.start == pc && idleLoop.branch == branchPC;
+    const bool unchanged = sameLoop && regs == idleLoop.regs && ime == idleLoop.ime && !imeScheduled;
+
+    if (!sameLoop) {
+        idleLoop.start = pc;
+        idleLoop.branch = branchPC;
+        idleLoop.analyzed = false;
+    }
+
+    // Deux itérations de même durée qui laissent le CPU dans le même état, sans
+    // événement pendant la dernière : tant qu'aucun événement n'a lieu, les
+    // suivantes liront les mêmes valeurs
+    if (unchanged && length == idleLoop.length && length <= MAX_IDLE_LOOP_CYCLES && idleLoop.nextEvent > now) {
+        if (!idleLoop.analyzed || idleLoop.analyzedRegs != regs) {
+            idleLoop.pollOnly = isPollOnlyLoop(pc, branchPC);
+            idleLoop.analyzedRegs = regs;
+            idleLoop.analyzed = true;
+        }
+
+        if (idleLoop.pollOnly) {
+            const uint64_t budget = next > now ? std::min(next - now, MAX_HALT_SKIP) : 0;
+            // Itérations entières uniquement, pour que la lecture suivante tombe au même cycle
+            const uint64_t skip = budget - budget % length;
+
+            if (skip > 0) {
+                idleStats.skips++;
+                idleStats.skippedCycles += skip;
+                addCycles(static_cast<int>(skip));
+            }
         }
-        return;
     }
 
-    // ====================================================================
-    // SET b, r (set bit)
-    // ====================================================================
-    if ((opcode & 0xC0) == 0xC0) {
-        if (reg == 6) {
-            uint8_t val = mmu.read(hl);
-            val |= (1 << bit);
-            mmu.write(hl, val);
-            addCycles(16);
+    idleLoop.regs = regs;
+    idleLoop.ime = ime;
+    idleLoop.length = sameLoop ? length : 0;
+    idleLoop.lastTime = scheduler.now();
+    idleLoop.nextEvent = scheduler.nextEventTime();
+}
+
+bool GB_CPU::isPollOnlyLoop(uint16_t start, uint16_t branchPC) const {
+    uint16_t addr = start;
+
+    while (addr < branchPC) {
+        const uint8_t opcode = mmu.read(addr);
+        uint8_t length = 1;
+        bool readsMemory = false;
+        uint16_t source = 0;
+
+        if (opcode == 0x00) {
+            // NOP
+        } else if (opcode >= 0x40 && opcode < 0xC0 && (opcode & 0xF8) != 0x70) {
+            // LD r, r' / ALU A, r (LD (HL), r et HALT exclus)
+            if ((opcode & 0x07) == 6) { readsMemory = true; source = hl; }
+        } else if ((opcode & 0xC7) == 0xC6) {
+            length = 2;  // ALU A, n
+        } else if ((opcode & 0xC7) == 0x06 && opcode != 0x36) {
+            length = 2;  // LD r, n
+        } else if (((opcode & 0xC7) == 0x04 || (opcode & 0xC7) == 0x05) && (opcode & 0x38) != 0x30) {
+            // INC r / DEC r
+        } else if (opcode == 0x07 || opcode == 0x0F || opcode == 0x17 || opcode == 0x1F ||
+                   opcode == 0x2F || opcode == 0x37 || opcode == 0x3F) {
+            // RLCA, RRCA, RLA, RRA, CPL, SCF, CCF
+        } else if (opcode == 0x0A || opcode == 0x1A) {
+            readsMemory = true;
+            source = (opcode == 0x0A) ? bc : de;
+        } else if (opcode == 0xF0) {
+            length = 2;
+            readsMemory = true;
+            source = 0xFF00 | mmu.read(addr + 1);
+        } else if (opcode == 0xF2) {
+            readsMemory = true;
+            source = 0xFF00 | c;
+        } else if (opcode == 0xFA) {
+            length = 3;
+            readsMemory = true;
+            source = mmu.read(addr + 1) | (mmu.read(addr + 2) << 8);
+        } else if (opcode == 0xCB) {
+            const uint8_t cb = mmu.read(addr + 1);
+            length = 2;
+            if ((cb & 0x07) == 6) {
+                if (cb < 0x40 || cb >= 0x80) return false;  // Écriture dans (HL)
+                readsMemory = true;                         // BIT n, (HL)
+                source = hl;
+            }
         } else {
-            getRegister(reg) |= (1 << bit);
-            addCycles(8);
+            return false;
         }
-        return;
+
+        if (readsMemory && !isPollableAddress(source)) return false;
+        addr += length;
     }
 
-    // ====================================================================
-    // ROTATIONS & SHIFTS (0x00-0x3F)
-    // ====================================================================
+    return addr == branchPC;
+}
 
-    // Helper pour appliquer sur registre ou (HL)
-    auto applyOp = [&](auto operation) {
-        if (reg == 6) {
-            uint8_t val = mmu.read(hl);
-            val = operation(val);
-            mmu.write(hl, val);
-            addCycles(16);
-        } else {
-            getRegister(reg) = operation(getRegister(reg));
-            addCycles(8);
+bool GB_CPU::isPollableAddress(uint16_t addr) {
+    if (addr < 0xA000) return true;   // ROM, VRAM
+    if (addr < 0xC000) return false;  // RAM cartouche (RTC)
+    if (addr < 0xFEA0) return true;   // WRAM, echo, OAM : seule une interruption peut y écrire
+    if (addr >= 0xFF80) return true;  // HRAM, IE
+
+    // Registres modifiés uniquement par un événement du scheduler (DIV et TIMA
+    // sont calculés à la lecture, sans événement : ils ne sont pas concernés)
+    switch (addr) {
+        case 0xFF00:  // P1
+        case 0xFF01:  // SB
+        case 0xFF02:  // SC
+        case 0xFF0F:  // IF
+        case 0xFF41:  // STAT
+        case 0xFF44:  // LY
+            return true;
+        default:
+            return false;
+    }
+}
+
+// ============================================================================
+// Cache de blocs
+// ============================================================================
+// Les micro-ops appellent les mêmes handlers que l'interpréteur : PC est placé
+// après l'opcode et chaque handler lit ses opérandes et compte ses cycles comme
+// d'habitude. Ce qui disparaît par instruction : la lecture de l'opcode, la
+// table de dispatch, le préfixe CB et le préambule de step() (interruptions,
+// EI, HALT), qui n'est rejoué qu'entre deux blocs.
+
+void GB_CPU::setBackend(GB_CPUBackend value) {
+    if (value == GB_CPUBackend::Jit) {
+#ifdef GB_JIT_ENABLED
+        if (!jit) {
+            jit = std::make_unique<GB_Jit>(*this, mmu);
+            jitState.readPages = mmu.getReadPageTable();
+            jitState.writePages = mmu.getWritePageTable();
+            jitState.hram = mmu.getHRAM();
+            jitState.bailout = &GB_Jit::bailout;
+            jitState.bailoutChecked = &GB_Jit::bailoutChecked;
+            jitState.loadCarry = &GB_Jit::loadCarry;
+            jitState.idleLoop = &GB_Jit::idleLoop;
         }
+        if (!jit->isAvailable()) {
+            LOG_WARN("JIT unavailable, using the block cache");
+            value = GB_CPUBackend::BlockCache;
+        }
+#else
+        LOG_WARN("Built without BUILD_GB_JIT, using the block cache");
+        value = GB_CPUBackend::BlockCache;
+#endif
+    }
+
+    if (value == backend) return;
+    backend = value;
+    clearBlockCache();
+}
+
+void GB_CPU::clearBlockCache() {
+    codePages.clear();
+    codePages.resize(mmu.getCodePageCount());
+    pageInvalidations.assign(codePages.size(), 0);
+    retiredPages.clear();
+    blockStats = {};
+}
+
+void GB_CPU::invalidateCodePage(uint32_t id) {
+    if (id >= codePages.size() || !codePages[id]) return;
+
+    // Le bloc en cours peut appartenir à cette page : elle n'est libérée qu'au bloc suivant
+    retiredPages.push_back(std::move(codePages[id]));
+    if (pageInvalidations[id] < MAX_PAGE_INVALIDATIONS) pageInvalidations[id]++;
+    blockStats.invalidated++;
+}
+
+bool GB_CPU::runBlock(uint64_t until) {
+    // Même préambule que step() : interruption à servir, EI en attente, HALT
+    if (halted || imeScheduled || (ime && interrupts.getPending())) return false;
+
+    const uint32_t id = mmu.getCodePage(pc);
+    if (id == GB_MMU::NO_CODE_PAGE) return false;
+
+    // ROM chargée après le dernier reset
+    if (id >= codePages.size()) clearBlockCache();
+
+    retiredPages.clear();
+
+    std::unique_ptr<CodePage>& slot = codePages[id];
+    if (!slot) {
+        // Code et données mêlés : la page est réécrite en continu
+        if (pageInvalidations[id] >= MAX_PAGE_INVALIDATIONS) return false;
+        slot = std::make_unique<CodePage>();
+    }
+
+    CodePage& page = *slot;
+    int16_t index = page.blockIndex[pc & 0xFF];
+    if (index == UNDECODED) index = decodeBlock(page, pc);
+    if (index == NO_BLOCK) return false;
+
+    Block& block = page.blocks[index];
+    blockStats.executed++;
+
+#ifdef GB_JIT_ENABLED
+    if (backend == GB_CPUBackend::Jit && runNative(page, block, pc, until)) {
+        return true;
+    }
+#endif
+
+    // Pas de test par instruction quand le bloc se termine avant la fin de
+    // frame et, IME actif, avant le prochain événement : seuls un événement
+    // ou une écriture peuvent lever une interruption
+    const uint64_t end = scheduler.now() + block.cycles;
+    if (end <= until && (!ime || end <= scheduler.nextEventTime())) {
+        executeBlock<false>(page.ops.data() + block.first, block.count, until);
+    } else {
+        executeBlock<true>(page.ops.data() + block.first, block.count, until);
+    }
+    return true;
+}
+
+template<bool CHECKED>
+void GB_CPU::executeBlock(const MicroOp* ops, uint16_t count, uint64_t until) {
+    const uint32_t generation = mmu.getCodeGeneration();
+
+    // Une interruption ne peut être levée que par un événement ou par une
+    // écriture : entre deux, un seul test de l'horloge par instruction
+    auto nextCheck = [&]() {
+        return ime ? std::min(until, scheduler.nextEventTime()) : until;
     };
+    uint64_t limit = nextCheck();
 
-    switch (opcode & 0xF8) {
-        // RLC (rotate left circular)
-        case 0x00:
-            applyOp([&](uint8_t val) {
-                uint8_t carry = (val & 0x80) >> 7;
-                val = (val << 1) | carry;
-                setFlag(Z_FLAG, val == 0);
-                setFlag(N_FLAG, false);
-                setFlag(H_FLAG, false);
-                setFlag(C_FLAG, carry != 0);
-                return val;
-            });
-            break;
+    for (uint16_t i = 0; i < count; ++i) {
+        const MicroOp& op = ops[i];
+        pc = op.next;
+        addCycles(4);
+        (this->*op.handler)();
 
-        // RRC (rotate right circular)
-        case 0x08:
-            applyOp([&](uint8_t val) {
-                uint8_t carry = val & 0x01;
-                val = (val >> 1) | (carry << 7);
-                setFlag(Z_FLAG, val == 0);
-                setFlag(N_FLAG, false);
-                setFlag(H_FLAG, false);
-                setFlag(C_FLAG, carry != 0);
-                return val;
-            });
-            break;
+        if (op.writes) {
+            // Banque ROM, DMA ou code modifié : la suite du bloc n'est plus sûre
+            if (mmu.getCodeGeneration() != generation) return;
 
-        // RL (rotate left through carry)
-        case 0x10:
-            applyOp([&](uint8_t val) {
-                uint8_t oldCarry = getFlag(C_FLAG) ? 1 : 0;
-                uint8_t newCarry = (val & 0x80) >> 7;
-                val = (val << 1) | oldCarry;
-                setFlag(Z_FLAG, val == 0);
-                setFlag(N_FLAG, false);
-                setFlag(H_FLAG, false);
-                setFlag(C_FLAG, newCarry != 0);
-                return val;
-            });
-            break;
+            // Écriture dans IF/IE, ou événement replanifié plus tôt (TAC, LCDC...)
+            if (ime && (interrupts.getPending() || scheduler.nextEventTime() < limit)) {
+                if constexpr (!CHECKED) return;
+                if (interrupts.getPending()) return;
+                limit = nextCheck();
+            }
+        }
 
-        // RR (rotate right through carry)
-        case 0x18:
-            applyOp([&](uint8_t val) {
-                uint8_t oldCarry = getFlag(C_FLAG) ? 1 : 0;
-                uint8_t newCarry = val & 0x01;
-                val = (val >> 1) | (oldCarry << 7);
-                setFlag(Z_FLAG, val == 0);
-                setFlag(N_FLAG, false);
-                setFlag(H_FLAG, false);
-                setFlag(C_FLAG, newCarry != 0);
-                return val;
-            });
-            break;
+        if constexpr (CHECKED) {
+            if (scheduler.now() >= limit) {
+                if (scheduler.now() >= until || (ime && interrupts.getPending())) return;
+                limit = nextCheck();
+            }
+        }
+    }
+}
 
-        // SLA (shift left arithmetic)
-        case 0x20:
-            applyOp([&](uint8_t val) {
-                uint8_t carry = (val & 0x80) >> 7;
-                val = val << 1;
-                setFlag(Z_FLAG, val == 0);
-                setFlag(N_FLAG, false);
-                setFlag(H_FLAG, false);
-                setFlag(C_FLAG, carry != 0);
-                return val;
-            });
-            break;
+#ifdef GB_JIT_ENABLED
+bool GB_CPU::runNative(CodePage& page, Block& block, uint16_t start, uint64_t until) {
+    if (!block.native || block.nativeEpoch != jit->getEpoch()) {
+        if (block.hits < JIT_THRESHOLD) {
+            block.hits++;
+            return false;
+        }
+        const uint8_t* body = nullptr;
+        block.native = jit->compile(start, block.count, page.chain, body);
+        block.nativeEpoch = jit->getEpoch();
+
+        // Cache de code vidé : plus aucun bloc chaîné n'est valide
+        if (jitEpoch != jit->getEpoch()) {
+            for (auto& codePage : codePages) {
+                if (codePage) codePage->chain.fill(nullptr);
+            }
+            jitEpoch = jit->getEpoch();
+        }
+        if (!block.native) return false;
+        page.chain[start & 0xFF] = body;
+    }
 
-        // SRA (shift right arithmetic - preserve sign bit)
-        case 0x28:
-            applyOp([&](uint8_t val) {
-                uint8_t carry = val & 0x01;
-                uint8_t sign = val & 0x80;
-                val = (val >> 1) | sign;
-                setFlag(Z_FLAG, val == 0);
-                setFlag(N_FLAG, false);
-                setFlag(H_FLAG, false);
-                setFlag(C_FLAG, carry != 0);
-                return val;
-            });
-            break;
+    const uint64_t now = scheduler.now();
+    const uint64_t limit = std::min(until, scheduler.nextEventTime());
+    if (limit <= now) return false;
 
-        // SWAP (swap nibbles)
-        case 0x30:
-            applyOp([&](uint8_t val) {
-                val = ((val & 0x0F) << 4) | ((val & 0xF0) >> 4);
-                setFlag(Z_FLAG, val == 0);
-                setFlag(N_FLAG, false);
-                setFlag(H_FLAG, false);
-                setFlag(C_FLAG, false);
-                return val;
-            });
-            break;
+    jitState.budget = limit - now;
+    jitState.limit = limit;
+    jitState.until = until;
+    jitState.generation = mmu.getCodeGeneration();
+    jitState.counted = 0;
 
-        // SRL (shift right logical)
-        case 0x38:
-            applyOp([&](uint8_t val) {
-                uint8_t carry = val & 0x01;
-                val = val >> 1;
-                setFlag(Z_FLAG, val == 0);
-                setFlag(N_FLAG, false);
-                setFlag(H_FLAG, false);
-                setFlag(C_FLAG, carry != 0);
-                return val;
-            });
-            break;
+    const uint32_t result = block.native(this);
+    const uint32_t pending = (result >> 16) & 0x7FFF;
+    if (pending > jitState.counted) addCycles(static_cast<int>(pending - jitState.counted));
+    return true;
+}
 
-        default:
-            LOG_ERROR("Unimplemented CB opcode: {:#04x}", opcode);
-            addCycles(8);
-            break;
+bool GB_CPU::jitMustStop() const {
+    // Banque ROM, DMA ou code modifié, événement replanifié plus tôt, ou IRQ
+    return mmu.getCodeGeneration() != jitState.generation || scheduler.nextEventTime() < jitState.limit ||
+           (ime && interrupts.getPending());
+}
+#endif
+
+int16_t GB_CPU::decodeBlock(CodePage& page, uint16_t start) {
+    // Le bloc ne sort pas de sa page (en HRAM, IE en 0xFFFF est exclu)
+    const uint32_t pageEnd = (start >= 0xFF80) ? 0xFFFF : (start | 0xFFu) + 1;
+
+    Block block{static_cast<uint32_t>(page.ops.size()), 0, 0};
+    uint32_t addr = start;
+
+    while (block.count < MAX_BLOCK_OPS) {
+        const uint8_t opcode = mmu.read(addr);
+        const uint8_t length = instructionLength(opcode);
+        if (addr + length > pageEnd) break;
+
+        const uint8_t cb = (opcode == 0xCB) ? mmu.read(addr + 1) : 0;
+        MicroOp op;
+        op.handler = (opcode == 0xCB) ? cbTable[cb] : opTable[opcode];
+        op.next = static_cast<uint16_t>(addr + (opcode == 0xCB ? 2 : 1));
+        op.writes = writesMemory(opcode, cb);
+        page.ops.push_back(op);
+
+        block.count++;
+        block.cycles += maxInstructionCycles(opcode, cb);
+        addr += length;
+
+        if (endsBlock(opcode)) break;
     }
+
+    int16_t index = NO_BLOCK;
+    if (block.count > 0) {
+        index = static_cast<int16_t>(page.blocks.size());
+        page.blocks.push_back(block);
+        blockStats.decoded++;
+
+        // Code en RAM : la première écriture dans la page jettera ses blocs
+        if (start >= 0xC000) mmu.protectCodePage(start >> 8);
+    }
+
+    page.blockIndex[start & 0xFF] = index;
+    return index;
+}
+
+uint8_t GB_CPU::instructionLength(uint8_t opcode) {
+    const uint8_t x = opcode >> 6;
+    const uint8_t y = (opcode >> 3) & 0x07;
+    const uint8_t z = opcode & 0x07;
+
+    if (x == 0) {
+        if (z == 0) return (y == 0) ? 1 : (y == 1) ? 3 : 2;  // NOP / LD (nn), SP / STOP, JR
+        if (z == 1) return (y & 1) ? 1 : 3;                   // ADD HL, rr / LD rr, nn
+        return (z == 6) ? 2 : 1;                              // LD r, n
+    }
+    if (x != 3) return 1;
+
+    switch (z) {
+        case 0: return (y < 4) ? 1 : 2;                        // RET cc / LDH, ADD SP, LD HL, SP+n
+        case 2: return (y < 4 || y == 5 || y == 7) ? 3 : 1;   // JP cc / LD (nn), A / LD A, (nn)
+        case 3: return (opcode == 0xC3) ? 3 : (opcode == 0xCB) ? 2 : 1;
+        case 4: return (y < 4) ? 3 : 1;                        // CALL cc
+        case 5: return (opcode == 0xCD) ? 3 : 1;
+        case 6: return 2;                                      // ALU A, n
+        default: return 1;
+    }
+}
+
+uint8_t GB_CPU::maxInstructionCycles(uint8_t opcode, uint8_t cb) {
+    // Cycles comptés par step() (lecture de l'opcode comprise), branche prise
+    const uint8_t x = opcode >> 6;
+    const uint8_t y = (opcode >> 3) & 0x07;
+    const uint8_t z = opcode & 0x07;
+
+    if (opcode == 0xCB) return 4 + (((cb & 0x07) != 6) ? 8 : ((cb >> 6) == 1) ? 12 : 16);  // BIT n, (HL) ne réécrit pas
+    if (x == 1 || x == 2) return 4 + ((y == 6 && x == 1) || z == 6 ? 8 : 4);
+    if (x == 3) {
+        // Borne serrée : le JIT passe par le chemin vérifié dès qu'elle
+        // dépasse le budget restant
+        switch (z) {
+            case 0: return 4 + ((y < 4) ? 20 : (y == 5) ? 16 : 12);  // RET cc / LDH / ADD SP / LD HL, SP+e
+            case 1: return 4 + ((y & 1) == 0 ? 12 : (y == 5) ? 4 : (y == 7) ? 8 : 16);  // POP / RET / JP (HL) / LD SP, HL
+            case 2: return 4 + ((y < 4 || y == 5 || y == 7) ? 16 : 8);  // JP cc / LD (nn) / LD (C)
+            case 3: return 4 + ((opcode == 0xC3) ? 16 : (opcode == 0xF3 || opcode == 0xFB) ? 4 : 24);
+            case 5: return 4 + ((y & 1) == 0 ? 16 : 24);            // PUSH / CALL
+            case 6: return 4 + 8;                                   // ALU A, n
+            case 7: return 4 + 16;                                  // RST
+            default: return 4 + 24;                                 // CALL cc
+        }
+    }
+
+    switch (z) {
+        case 0: return 4 + ((y == 1) ? 20 : 12);  // LD (nn), SP / JR
+        case 1: return 4 + ((y & 1) ? 8 : 12);    // ADD HL, rr / LD rr, nn
+        case 4:
+        case 5: return 4 + ((y == 6) ? 12 : 4);
+        case 6: return 4 + ((y == 6) ? 12 : 8);
+        case 7: return 4 + 4;
+        default: return 4 + 8;
+    }
+}
+
+bool GB_CPU::endsBlock(uint8_t opcode) {
+    // Sauts, appels, retours, HALT, STOP, et EI/DI qui changent le préambule
+    const uint8_t x = opcode >> 6;
+    const uint8_t y = (opcode >> 3) & 0x07;
+    const uint8_t z = opcode & 0x07;
+
+    if (x == 0) return z == 0 && y >= 2;  // STOP, JR, JR cc
+    if (x == 1) return opcode == 0x76;    // HALT
+    if (x == 2) return false;
+
+    switch (z) {
+        case 0: return y < 4;                            // RET cc
+        case 1: return y == 1 || y == 3 || y == 5;       // RET, RETI, JP (HL)
+        case 2: return y < 4;                            // JP cc
+        case 3: return opcode == 0xC3 || opcode == 0xF3 || opcode == 0xFB;  // JP, DI, EI
+        case 4: return y < 4;                            // CALL cc
+        case 5: return opcode == 0xCD;                   // CALL
+        case 7: return true;                             // RST
+        default: return false;
+    }
+}
+
+bool GB_CPU::writesMemory(uint8_t opcode, uint8_t cb) {
+    const uint8_t x = opcode >> 6;
+    const uint8_t y = (opcode >> 3) & 0x07;
+    const uint8_t z = opcode & 0x07;
+
+    if (opcode == 0xCB) return (cb & 0x07) == 6 && (cb < 0x40 || cb >= 0x80);  // Tout sauf BIT n, (HL)
+    if (x == 1) return y == 6 && opcode != 0x76;  // LD (HL), r
+    if (x == 2) return false;
+
+    if (x == 0) {
+        if (z == 2) return (y & 1) == 0;          // LD (BC)/(DE)/(HL+)/(HL-), A
+        if (z >= 4 && z <= 6) return y == 6;      // INC/DEC/LD (HL)
+        return opcode == 0x08;                    // LD (nn), SP
+    }
+
+    // LDH (n), A / LD (C), A / LD (nn), A, PUSH, CALL, RST
+    return opcode == 0xE0 || opcode == 0xE2 || opcode == 0xEA ||
+           (z == 5 && ((y & 1) == 0 || opcode == 0xCD)) || (z == 4 && y < 4) || z == 7;
 }
 
 void GB_CPU::addCycles(int c)
 {
     cycles += c;
-    timer.step(c);
-    ppu.step(c);
+    // Le timer et le PPU ne tournent que lorsqu'un de leurs événements est dû
+    scheduler.advance(c);
 }
 
-void GB_CPU::handleInterrupts(GB_MMU& mmu) {
-    uint8_t IF = mmu.read(0xFF0F);
-    uint8_t IE = mmu.read(0xFFFF);
-    uint8_t triggered = IF & IE;
+void GB_CPU::handleInterrupts() {
+    uint8_t triggered = interrupts.getPending();
 
-    if (halted && (triggered & 0x1F)) {
+    if (halted && triggered) {
         halted = false;
         addCycles(4);
     }
 
-    if (!ime || (triggered & 0x1F) == 0) return;
+    if (!ime || triggered == 0) return;
 
     ime = false;
     uint8_t interrupt = 0;
@@ -786,5 +1158,5 @@ void GB_CPU::handleInterrupts(GB_MMU& mmu) {
     addCycles(4); // Le saut vers le vecteur prend les 4 derniers cycles
 
     // On efface le flag à la toute fin
-    mmu.write(0xFF0F, mmu.read(0xFF0F) & ~(1 << interrupt));
+    interrupts.acknowledge(interrupt);
 }
\ No newline at end of file
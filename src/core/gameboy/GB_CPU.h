@@ -4,19 +4,36 @@
 #pragma once
 
 #include "common/types.h"
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#ifdef GB_JIT_ENABLED
+#include "core/gameboy/GB_Jit.h"
+#endif
 
 class GB_MMU;
-class GB_PPU;
-class GB_Timer;
+class GB_Scheduler;
+class GB_Interrupts;
+
+// Moteur d'exécution, changeable entre deux frames
+enum class GB_CPUBackend {
+    Interpreter,  // Une instruction à la fois, décodée à chaque passage
+    BlockCache,   // Blocs de base décodés une fois, en cache par (banque ROM, PC)
+    Jit           // Blocs chauds traduits en x86-64 (BUILD_GB_JIT), sinon cache de blocs
+};
 
 class GB_CPU
 {
 public:
-    explicit GB_CPU(GB_MMU& mmu, GB_PPU& ppu, GB_Timer& timer);
-    ~GB_CPU() = default;
+    GB_CPU(GB_MMU& mmu, GB_Scheduler& scheduler, GB_Interrupts& interrupts);
+    ~GB_CPU();
 
     void reset();
     void step();
+    // Exécute jusqu'à ce que l'horloge maître atteigne until, avec le moteur choisi
+    void run(uint64_t until);
     void execute(uint8_t opcode);
     void executeCB(uint8_t opcode);
 
@@ -26,9 +43,30 @@ public:
     void resetCycles() { cycles = 0; }
     void addCycles(int c);
 
-    void handleInterrupts(GB_MMU& mmu);
+    void handleInterrupts();
 
     bool isIME() const { return ime; }
+
+    // Boucles d'attente (polling LY/STAT/IF/P1) sautées jusqu'au prochain événement
+    struct IdleLoopStats {
+        uint64_t skips = 0;          // Nombre de sauts effectués
+        uint64_t skippedCycles = 0;  // Cycles sautés au total
+    };
+    const IdleLoopStats& getIdleLoopStats() const { return idleStats; }
+
+    void setBackend(GB_CPUBackend value);
+    GB_CPUBackend getBackend() const { return backend; }
+
+    struct BlockCacheStats {
+        uint64_t decoded = 0;      // Blocs décodés
+        uint64_t executed = 0;     // Blocs exécutés
+        uint64_t invalidated = 0;  // Pages de RAM jetées après une écriture
+    };
+    const BlockCacheStats& getBlockCacheStats() const { return blockStats; }
+
+    // F calculé à la demande (flags paresseux) : à utiliser à la place de f/af hors du CPU
+    uint8_t getF() const { return computeFlags(); }
+    uint16_t getAF() const { return (a << 8) | getF(); }
     void setIME(bool value) { ime = value; }
 
     // Registres 16 bits
@@ -46,8 +84,8 @@ public:
 
 private:
     GB_MMU& mmu;
-        GB_PPU& ppu;
-        GB_Timer& timer;
+    GB_Scheduler& scheduler;
+    GB_Interrupts& interrupts;
 
     bool ime = false;
     bool imeScheduled = false;
@@ -56,6 +94,38 @@ private:
     bool halted = false;
     int cycles = 0;
 
+    // HALT : saut jusqu'au prochain événement du scheduler
+    static constexpr uint64_t MAX_HALT_SKIP = 4560;  // 10 lignes
+    int haltSkipCycles() const;
+
+    // Détection des boucles d'attente : une boucle courte dont le corps ne fait que
+    // lire des registres qui ne changent que sur un événement du scheduler (LY, STAT,
+    // IF, P1, SB/SC) ou de la RAM que seule une interruption peut modifier. Si deux
+    // itérations consécutives laissent les registres du CPU identiques, les
+    // suivantes sont sautées jusqu'au prochain événement.
+    static constexpr uint16_t MAX_IDLE_LOOP_BYTES = 16;
+    static constexpr uint64_t MAX_IDLE_LOOP_CYCLES = 256;
+
+    struct IdleLoop {
+        uint16_t start = 0;
+        uint16_t branch = 0;         // Adresse du saut qui referme la boucle
+        uint64_t lastTime = 0;       // Timestamp du passage précédent sur le saut
+        uint64_t length = 0;         // Durée de la dernière itération
+        uint64_t nextEvent = 0;      // Prochain événement vu au passage précédent
+        std::array<uint16_t, 5> regs{};
+        bool ime = false;
+        bool analyzed = false;
+        bool pollOnly = false;       // Résultat de l'analyse statique du corps
+        std::array<uint16_t, 5> analyzedRegs{};  // Les adresses (HL), (BC), (C) en dépendent
+    };
+
+    IdleLoop idleLoop;
+    IdleLoopStats idleStats;
+
+    void checkIdleLoop(uint16_t branchPC);
+    bool isPollOnlyLoop(uint16_t start, uint16_t branchPC) const;
+    static bool isPollableAddress(uint16_t addr);
+
     enum Flags {
         Z_FLAG = 0x80,
         N_FLAG = 0x40,
@@ -63,8 +133,174 @@ private:
         C_FLAG = 0x10
     };
 
-    inline bool getFlag(Flags flag) const { return f & flag; }
+    // Dispatch par tables (générées à la compilation)
+    using OpHandler = void (GB_CPU::*)();
+    static const std::array<OpHandler, 256> opTable;
+    static const std::array<OpHandler, 256> cbTable;
+
+    template<std::size_t... I>
+    static constexpr std::array<OpHandler, 256> makeOpTable(std::index_sequence<I...>);
+    template<std::size_t... I>
+    static constexpr std::array<OpHandler, 256> makeCBTable(std::index_sequence<I...>);
+
+    // Cache de blocs : une suite d'instructions sans saut est décodée une fois
+    // en micro-ops (handler déjà résolu, préfixe CB compris). Un bloc ne déborde
+    // jamais de sa page de 256 octets, l'unité d'invalidation en RAM.
+    GB_CPUBackend backend = GB_CPUBackend::Interpreter;
+
+    static constexpr size_t MAX_BLOCK_OPS = 64;
+    static constexpr uint8_t MAX_PAGE_INVALIDATIONS = 32;  // Au-delà, la page reste à l'interpréteur
+    static constexpr int16_t UNDECODED = -1;
+    static constexpr int16_t NO_BLOCK = -2;  // Laissé à l'interpréteur
+
+    struct MicroOp {
+        OpHandler handler;
+        uint16_t next;    // PC après l'opcode (et le préfixe CB), avant les opérandes
+        bool writes;      // Écriture mémoire : banque, DMA, code ou IRQ ont pu changer
+    };
+
+    struct Block {
+        uint32_t first;   // Premier micro-op dans CodePage::ops
+        uint16_t count;
+        uint16_t cycles;  // Borne haute de la durée du bloc
+#ifdef GB_JIT_ENABLED
+        uint16_t hits = 0;
+        uint32_t nativeEpoch = 0;
+        GB_Jit::NativeBlock native = nullptr;
+#endif
+    };
+
+    struct CodePage {
+        std::array<int16_t, 256> blockIndex;  // Par octet de la page : bloc qui y commence
+        std::vector<Block> blocks;
+        std::vector<MicroOp> ops;
+#ifdef GB_JIT_ENABLED
+        GB_Jit::ChainTable chain{};           // Corps natif des blocs de la page (chaînage)
+#endif
+        CodePage() { blockIndex.fill(UNDECODED); }
+    };
+
+    std::vector<std::unique_ptr<CodePage>> codePages;      // Indexé par GB_MMU::getCodePage
+    std::vector<uint8_t> pageInvalidations;
+    std::vector<std::unique_ptr<CodePage>> retiredPages;   // Invalidées pendant un bloc, libérées au suivant
+    BlockCacheStats blockStats;
+
+    void clearBlockCache();
+    void invalidateCodePage(uint32_t id);
+    bool runBlock(uint64_t until);
+    int16_t decodeBlock(CodePage& page, uint16_t start);
+    template<bool CHECKED> void executeBlock(const MicroOp* ops, uint16_t count, uint64_t until);
+    static uint8_t instructionLength(uint8_t opcode);
+    static uint8_t maxInstructionCycles(uint8_t opcode, uint8_t cb);
+    static bool endsBlock(uint8_t opcode);
+    static bool writesMemory(uint8_t opcode, uint8_t cb);
+
+#ifdef GB_JIT_ENABLED
+    // Recompilateur : un bloc est traduit à sa JIT_THRESHOLD-ième exécution.
+    // Assez haut pour que le code d'initialisation reste au cache de blocs :
+    // une compilation coûte des dizaines de microsecondes (mprotect compris)
+    friend class GB_Jit;
+    static constexpr uint16_t JIT_THRESHOLD = 128;
+
+    // Lu et écrit par le code natif, relativement au CPU
+    struct JitState {
+        uint64_t budget = 0;   // Cycles avant limit, plus la borne des cycles déjà écoulés dans le bloc
+        uint64_t limit = 0;    // Fin de frame ou prochain événement
+        uint64_t until = 0;
+        const uint8_t* const* readPages = nullptr;
+        uint8_t* const* writePages = nullptr;
+        uint8_t* hram = nullptr;
+        uint32_t (*bailout)(GB_CPU*, uint32_t, uint32_t, uint32_t, uint32_t) = nullptr;
+        uint32_t (*bailoutChecked)(GB_CPU*, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) = nullptr;
+        void (*loadCarry)(GB_CPU*) = nullptr;
+        uint32_t (*idleLoop)(GB_CPU*, uint32_t, uint32_t) = nullptr;
+        uint32_t generation = 0;
+        uint32_t counted = 0;  // Cycles en attente déjà comptés par un handler
+        uint8_t carry = 0;     // Flag C, tenu à jour par le code natif
+    };
+
+    JitState jitState;
+    std::unique_ptr<GB_Jit> jit;
+    uint32_t jitEpoch = 0;  // Époque du cache de code reflétée dans les tables de chaînage
+
+    // Handlers appelés directement par le code natif (handler inliné) : PC
+    // après l'opcode et cycles à compter en argument, rend 1 si le bloc doit
+    // s'arrêter après une écriture
+    using JitHandler = uint32_t (*)(GB_CPU* cpu, uint32_t next, uint32_t cycles);
+    static const std::array<JitHandler, 256> jitOpTable;
+    static const std::array<JitHandler, 256> jitCBTable;
+
+    template<uint8_t OP, bool CB> static uint32_t jitOp(GB_CPU* cpu, uint32_t next, uint32_t cycles);
+    template<bool CB, std::size_t... I>
+    static constexpr std::array<JitHandler, 256> makeJitTable(std::index_sequence<I...>);
+
+    bool runNative(CodePage& page, Block& block, uint16_t start, uint64_t until);
+    bool jitMustStop() const;
+#endif
+
+    static constexpr uint8_t OPERAND_IMM = 8;  // Opérande immédiat (n) pour opALU
+
+    template<uint8_t R> uint8_t& reg8();
+    template<uint8_t P> uint16_t& reg16();
+    template<uint8_t R> uint8_t operand();
+    template<uint8_t CC> bool condition() const;
+
+    uint16_t fetch16();
+    void push16(uint16_t value);
+    uint16_t pop16();
+
+    // Handlers
+    template<uint8_t OP> void op();
+    template<uint8_t OP> void opCB();
+    template<uint8_t OP> void opMisc();
+    template<uint8_t DST, uint8_t SRC> void opLD();
+    template<uint8_t R> void opLDn();
+    template<uint8_t OPK, uint8_t R> void opALU();
+    template<uint8_t R> void opINC();
+    template<uint8_t R> void opDEC();
+    template<uint8_t P> void opADDHL();
+    template<uint8_t CC> void opJR();
+    template<uint8_t CC> void opJP();
+    template<uint8_t CC> void opCALL();
+    template<uint8_t CC> void opRET();
+    template<uint8_t P> void opPUSH();
+    template<uint8_t P> void opPOP();
+    template<uint8_t OPK> uint8_t rotate(uint8_t val);
+    void opHALT();
+
+    // Flags paresseux : on mémorise la dernière opération ALU et Z/N/H/C ne sont
+    // calculés que lorsque F est lu (saut conditionnel, PUSH AF, DAA, ADC/SBC, debugger)
+    enum class FlagOp : uint8_t { None, Add, Sub, And, Or, Inc, Dec };
+
+    struct LazyFlags {
+        FlagOp op = FlagOp::None;
+        uint8_t lhs = 0;
+        uint8_t rhs = 0;
+        uint8_t carry = 0;   // Retenue entrante (ADC/SBC) ou C conservé (INC/DEC)
+        uint8_t result = 0;
+    };
+
+    LazyFlags lazy;
+
+    uint8_t evalLazyFlags() const;
+    inline uint8_t computeFlags() const {
+        return lazy.op == FlagOp::None ? f : evalLazyFlags();
+    }
+    inline void materializeFlags() {
+        if (lazy.op != FlagOp::None) {
+            f = evalLazyFlags();
+            lazy.op = FlagOp::None;
+        }
+    }
+    inline void setLazyFlags(FlagOp op, uint8_t lhs, uint8_t rhs, uint8_t carry, uint8_t result) {
+        lazy = {op, lhs, rhs, carry, result};
+    }
+
+    inline bool getFlag(Flags flag) const { return computeFlags() & flag; }
+    // C seul (0 ou 1), sans évaluer Z/N/H : INC/DEC, ADC/SBC, rotations via C
+    uint8_t getCarry() const;
     inline void setFlag(Flags flag, bool value) {
+        materializeFlags();
         if (value) {
             f |= static_cast<uint8_t>(flag);
         } else {
@@ -72,4 +308,9 @@ private:
         }
         f &= 0xF0;
     }
+    // Les 4 flags d'un coup (rotations, shifts, ADD SP)
+    inline void setFlags(bool z, bool n, bool h, bool c) {
+        f = (z ? Z_FLAG : 0) | (n ? N_FLAG : 0) | (h ? H_FLAG : 0) | (c ? C_FLAG : 0);
+        lazy.op = FlagOp::None;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "core/gameboy/GB_Compositor.h"
+#include "utils/Logger.h"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GB_COMPOSITOR_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int LINE_WIDTH = 160;
+
+// Teintes vertes du DMG, dans l'ordre des octets du framebuffer (R, G, B, A)
+constexpr uint8_t SHADES[4][4] = {
+    {155, 188, 15, 255},   // 0: Blanc
+    {139, 172, 15, 255},   // 1: Gris clair
+    {48, 98, 48, 255},     // 2: Gris foncé
+    {15, 56, 15, 255}      // 3: Noir
+};
+
+void composeScalar(const uint8_t* indices, const uint32_t* lut, uint8_t* rgba) {
+    for (int x = 0; x < LINE_WIDTH; ++x) {
+        std::memcpy(rgba + x * 4, &lut[indices[x] & 0x03], 4);
+    }
+}
+
+#ifdef GB_COMPOSITOR_X86
+
+// 16 pixels par tour : chaque indice est comparé aux 4 valeurs possibles et
+// sélectionne sa couleur par masque (SSE2 n'a pas de lookup à index variable)
+__attribute__((target("sse2")))
+void composeSSE2(const uint8_t* indices, const uint32_t* lut, uint8_t* rgba) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i colors[4] = {
+        _mm_set1_epi32(static_cast<int>(lut[0])), _mm_set1_epi32(static_cast<int>(lut[1])),
+        _mm_set1_epi32(static_cast<int>(lut[2])), _mm_set1_epi32(static_cast<int>(lut[3]))
+    };
+    const __m128i values[4] = {
+        _mm_set1_epi32(0), _mm_set1_epi32(1), _mm_set1_epi32(2), _mm_set1_epi32(3)
+    };
+
+    for (int x = 0; x < LINE_WIDTH; x += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + x));
+        __m128i words[2] = { _mm_unpacklo_epi8(bytes, zero), _mm_unpackhi_epi8(bytes, zero) };
+
+        for (int half = 0; half < 2; ++half) {
+            __m128i lanes[2] = { _mm_unpacklo_epi16(words[half], zero), _mm_unpackhi_epi16(words[half], zero) };
+
+            for (int quad = 0; quad < 2; ++quad) {
+                __m128i pixel = _mm_and_si128(_mm_cmpeq_epi32(lanes[quad], values[0]), colors[0]);
+                for (int c = 1; c < 4; ++c) {
+                    pixel = _mm_or_si128(pixel, _mm_and_si128(_mm_cmpeq_epi32(lanes[quad], values[c]), colors[c]));
+                }
+                uint8_t* out = rgba + (x + half * 8 + quad * 4) * 4;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), pixel);
+            }
+        }
+    }
+}
+
+// 8 pixels par tour : indices élargis en 32 bits, qui servent directement de
+// sélecteurs dans la table des couleurs (vpermd)
+__attribute__((target("avx2")))
+void composeAVX2(const uint8_t* indices, const uint32_t* lut, uint8_t* rgba) {
+    const __m256i table = _mm256_setr_epi32(
+        static_cast<int>(lut[0]), static_cast<int>(lut[1]), static_cast<int>(lut[2]), static_cast<int>(lut[3]),
+        static_cast<int>(lut[0]), static_cast<int>(lut[1]), static_cast<int>(lut[2]), static_cast<int>(lut[3]));
+
+    for (int x = 0; x < LINE_WIDTH; x += 8) {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + x));
+        __m256i selectors = _mm256_cvtepu8_epi32(bytes);
+        __m256i pixels = _mm256_permutevar8x32_epi32(table, selectors);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + x * 4), pixels);
+    }
+}
+
+#endif
+
+}  // namespace
+
+GB_Compositor::GB_Compositor() {
+    composeLine = composeScalar;
+    name = "scalar";
+
+#ifdef GB_COMPOSITOR_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        composeLine = composeAVX2;
+        name = "AVX2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        composeLine = composeSSE2;
+        name = "SSE2";
+    }
+#endif
+
+    LOG_DEBUG("GB compositor: {}", name);
+}
+
+void GB_Compositor::compose(const uint8_t* indices, uint8_t palette, uint8_t* rgba) const {
+    uint32_t lut[4];
+    for (int i = 0; i < 4; ++i) {
+        std::memcpy(&lut[i], SHADES[(palette >> (i * 2)) & 0x03], 4);
+    }
+    composeLine(indices, lut, rgba);
+}
+
+void GB_Compositor::composePixel(uint8_t colorIndex, uint8_t palette, uint8_t* rgba) const {
+    std::memcpy(rgba, SHADES[(palette >> (colorIndex * 2)) & 0x03], 4);
+}
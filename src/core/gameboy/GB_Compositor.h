@@ -0,0 +1,23 @@
+#pragma once
+#include "common/types.h"
+
+// Dernière étape du rendu d'une ligne : applique la palette (BGP) aux 160
+// indices de couleur et écrit les pixels RGBA. L'implémentation (AVX2, SSE2
+// ou scalaire) est choisie une fois, à la construction, selon le CPU hôte.
+class GB_Compositor {
+public:
+    GB_Compositor();
+
+    void compose(const uint8_t* indices, uint8_t palette, uint8_t* rgba) const;
+    // Un pixel isolé (sprites) : palette appliquée à un indice de couleur
+    void composePixel(uint8_t colorIndex, uint8_t palette, uint8_t* rgba) const;
+
+    const char* getName() const { return name; }
+
+private:
+    // lut : couleur RGBA des 4 indices, palette déjà appliquée
+    using ComposeFn = void (*)(const uint8_t* indices, const uint32_t* lut, uint8_t* rgba);
+
+    ComposeFn composeLine = nullptr;
+    const char* name = "scalar";
+};
@@ -0,0 +1,179 @@
+#include "core/gameboy/GB_FifoRenderer.h"
+
+#include <algorithm>
+#include <cstring>
+
+using S = GB_PPUState;
+
+// Les teintes sont déjà calculées : le compositeur les convertit telles quelles
+static constexpr uint8_t IDENTITY_PALETTE = 0xE4;
+
+GB_FifoRenderer::GB_FifoRenderer(GB_PPUState& ppuState) : state(ppuState) {
+}
+
+void GB_FifoRenderer::reset() {
+    writes.clear();
+    shades.fill(0);
+    windowUsed = false;
+    drawingDots = 0;
+}
+
+int GB_FifoRenderer::beginDrawing() {
+    state.updateTileCache();
+    lineRegisters = state.readRasterRegisters();
+    writes.clear();
+
+    drawingDots = simulateLine();
+    return drawingDots;
+}
+
+int GB_FifoRenderer::midlineWrite(RasterReg reg, uint8_t value, int dot) {
+    // Les points déjà passés ne changent pas : seule la suite de la ligne
+    // voit la nouvelle valeur
+    writes.push_back({dot, reg, value});
+
+    drawingDots = simulateLine();
+    return drawingDots;
+}
+
+void GB_FifoRenderer::endDrawing() {
+    state.compositor.compose(shades.data(), IDENTITY_PALETTE, state.lineRGBA(state.currentScanline));
+    if (windowUsed) state.windowLine++;
+    writes.clear();
+}
+
+int GB_FifoRenderer::simulateLine() {
+    RasterRegisters regs = lineRegisters;
+    size_t nextWrite = 0;
+
+    const uint8_t ly = state.currentScanline;
+    const uint8_t* vram = state.vram();
+    const S::LineSprites& sprites = state.lineSprites[ly];
+    int nextSprite = 0;
+
+    // Pixels de sprites déjà fetchés, alignés sur l'écran : le premier sprite
+    // opaque sur un pixel le garde (priorité DMG)
+    struct ObjPixel {
+        uint8_t color;
+        uint8_t flags;
+    };
+    std::array<ObjPixel, 160> objLine{};
+
+    // FIFO du fond : le fetcher n'y pousse une tuile que lorsqu'elle est vide
+    uint8_t bgFifo[8];
+    int bgHead = 0;
+    int bgCount = 0;
+
+    int fetchDots = 0;       // Points passés sur le fetch en cours
+    int fetchCol = 0;        // Tuile suivante, depuis le début du fond ou de la fenêtre
+    bool inWindow = false;
+    int penaltyTile = -1;    // Dernière tuile ayant déjà fait attendre un fetch de sprite
+
+    int discard = regs[S::SCX] & 7;  // Décalage fin : pixels jetés en tête de ligne
+    int x = 0;
+    int dot = LINE_START_DOTS;
+    windowUsed = false;
+
+    while (x < 160) {
+        while (nextWrite < writes.size() && writes[nextWrite].dot <= dot) {
+            regs[writes[nextWrite].reg] = writes[nextWrite].value;
+            ++nextWrite;
+        }
+        uint8_t lcdc = regs[S::LCDC];
+
+        // Fenêtre : la FIFO est vidée et le fetcher repart sur la carte de la fenêtre
+        if (!inWindow && discard == 0 && (lcdc & 0x21) == 0x21 &&
+            ly >= regs[S::WY] && x + 7 >= regs[S::WX]) {
+            inWindow = true;
+            windowUsed = true;
+            bgCount = 0;
+            fetchDots = 0;
+            fetchCol = 0;
+            penaltyTile = -1;
+            discard = (x == 0) ? std::max(0, -S::windowX(regs[S::WX])) : 0;
+        }
+
+        // Sprite atteint : la sortie des pixels et le fetcher du fond sont suspendus
+        if (discard == 0 && nextSprite < sprites.count && sprites.sprites[nextSprite].x <= x + 8) {
+            const S::Sprite& sprite = sprites.sprites[nextSprite++];
+            if ((lcdc & 0x02) == 0) continue;
+
+            // Le premier sprite d'une tuile attend la fin du fetch de fond en cours
+            int offset = inWindow ? x + 7 - regs[S::WX] : x + regs[S::SCX];
+            int wait = 0;
+            if ((offset >> 3) != penaltyTile) {
+                wait = 5 - std::min(5, offset & 7);
+                penaltyTile = offset >> 3;
+            }
+            dot += wait + SPRITE_FETCH_DOTS;
+
+            int height = (lcdc & 0x04) ? 16 : 8;
+            const uint8_t* colors = state.spriteRow(sprite, ly, height);
+            bool flipX = (sprite.flags & 0x20) != 0;
+
+            for (int px = 0; px < 8; px++) {
+                int sx = sprite.x - 8 + px;
+                if (sx < x || sx >= 160 || objLine[sx].color) continue;
+
+                uint8_t color = colors[flipX ? 7 - px : px];
+                if (color) objLine[sx] = {color, sprite.flags};
+            }
+            continue;
+        }
+
+        // Un pixel sort de la FIFO à chaque point
+        if (bgCount > 0) {
+            uint8_t color = bgFifo[bgHead++];
+            bgCount--;
+
+            if (discard > 0) {
+                discard--;
+            } else {
+                // BG et fenêtre désactivés : couleur 0 blanche, les sprites restent affichés
+                uint8_t bgColor = (lcdc & 0x01) ? color : 0;
+                uint8_t shade = (lcdc & 0x01) ? (regs[S::BGP] >> (bgColor * 2)) & 3 : 0;
+
+                // Bit 7 : le sprite passe derrière les couleurs 1-3 du fond
+                const ObjPixel& obj = objLine[x];
+                if (obj.color && (lcdc & 0x02) && !((obj.flags & 0x80) && bgColor != 0)) {
+                    uint8_t palette = regs[(obj.flags & 0x10) ? S::OBP1 : S::OBP0];
+                    shade = (palette >> (obj.color * 2)) & 3;
+                }
+
+                shades[x++] = shade;
+            }
+        }
+
+        // Fetcher : une tuile tous les TILE_FETCH_DOTS, poussée dès que la FIFO est vide
+        if (fetchDots < TILE_FETCH_DOTS) fetchDots++;
+        if (fetchDots == TILE_FETCH_DOTS && bgCount == 0) {
+            uint16_t mapBase;
+            uint8_t tileRow, pixelY, col;
+
+            if (inWindow) {
+                mapBase = (lcdc & 0x40) ? 0x1C00 : 0x1800;
+                tileRow = state.windowLine / 8;
+                pixelY = state.windowLine % 8;
+                col = fetchCol & 31;
+            } else {
+                uint8_t y = ly + regs[S::SCY];
+                mapBase = (lcdc & 0x08) ? 0x1C00 : 0x1800;
+                tileRow = y / 8;
+                pixelY = y % 8;
+                col = ((regs[S::SCX] >> 3) + fetchCol) & 31;
+            }
+
+            uint16_t tile = S::bgTile(lcdc, vram[mapBase + tileRow * 32 + col]);
+            std::memcpy(bgFifo, state.tileCache.getRow(tile, pixelY), 8);
+
+            bgHead = 0;
+            bgCount = 8;
+            fetchDots = 0;
+            fetchCol++;
+        }
+
+        dot++;
+    }
+
+    return dot;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "core/gameboy/GB_PPU.h"
+#include <vector>
+
+// Renderer précis : le mode 3 est simulé point par point (fetcher du fond,
+// FIFO de pixels, fetch des sprites), ce qui donne sa durée réelle à chaque
+// ligne. Une écriture de registre pendant le mode 3 est datée au point près :
+// la ligne est rejouée avec elle et la fin du mode 3 replanifiée.
+class GB_FifoRenderer {
+public:
+    static constexpr const char* NAME = "Pixel FIFO";
+    static constexpr bool VARIABLE_DRAWING = true;
+
+    using RasterReg = GB_PPUState::RasterReg;
+    using RasterRegisters = GB_PPUState::RasterRegisters;
+
+    explicit GB_FifoRenderer(GB_PPUState& state);
+
+    void reset();
+    void beginFrame() {}
+    void endFrame() {}
+
+    int beginDrawing();
+    void endDrawing();
+
+    int midlineWrite(RasterReg reg, uint8_t value, int dot);
+
+private:
+    GB_PPUState& state;
+
+    // Temps du fetcher (en points)
+    static constexpr int LINE_START_DOTS = 6;     // Premier fetch de la ligne, jeté
+    static constexpr int TILE_FETCH_DOTS = 6;     // Numéro de tuile, octet bas, octet haut
+    static constexpr int SPRITE_FETCH_DOTS = 6;
+
+    struct MidlineWrite {
+        int dot;
+        RasterReg reg;
+        uint8_t value;
+    };
+
+    RasterRegisters lineRegisters{};   // Valeurs au début du mode 3
+    std::vector<MidlineWrite> writes;
+
+    // Résultat de la dernière simulation de la ligne
+    std::array<uint8_t, 160> shades{};  // Teintes finales (palettes appliquées)
+    bool windowUsed = false;
+    int drawingDots = 0;
+
+    int simulateLine();
+};
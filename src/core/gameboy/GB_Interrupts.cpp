@@ -0,0 +1,14 @@
+#include "core/gameboy/GB_Interrupts.h"
+#include "utils/Logger.h"
+
+GB_Interrupts::GB_Interrupts() {
+    reset();
+}
+
+void GB_Interrupts::reset() {
+    IF = 0;
+    IE = 0;
+    updatePending();
+
+    LOG_DEBUG("GB Interrupts reset");
+}
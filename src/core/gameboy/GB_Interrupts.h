@@ -0,0 +1,46 @@
+#pragma once
+#include "common/types.h"
+
+// Contrôleur d'interruptions : possède IF (0xFF0F) et IE (0xFFFF).
+// Le masque des interruptions en attente (IF & IE) est recalculé à chaque
+// écriture, le CPU n'a plus qu'un octet à tester avant chaque instruction.
+class GB_Interrupts {
+public:
+    enum Interrupt : uint8_t {
+        VBLANK = 0,
+        STAT   = 1,
+        TIMER  = 2,
+        SERIAL = 3,
+        JOYPAD = 4
+    };
+
+    GB_Interrupts();
+
+    void reset();
+
+    // Levée par un périphérique
+    inline void request(Interrupt interrupt) {
+        IF |= 1 << interrupt;
+        updatePending();
+    }
+    // Effacée par le CPU en entrant dans le vecteur
+    inline void acknowledge(uint8_t interrupt) {
+        IF &= ~(1 << interrupt);
+        updatePending();
+    }
+
+    uint8_t getPending() const { return pending; }
+
+    // Accès CPU par le bus (valeurs brutes, comme la mémoire de fond auparavant)
+    uint8_t readIF() const { return IF; }
+    uint8_t readIE() const { return IE; }
+    void writeIF(uint8_t value) { IF = value; updatePending(); }
+    void writeIE(uint8_t value) { IE = value; updatePending(); }
+
+private:
+    uint8_t IF = 0;
+    uint8_t IE = 0;
+    uint8_t pending = 0;  // IF & IE & 0x1F
+
+    inline void updatePending() { pending = IF & IE & 0x1F; }
+};
@@ -0,0 +1,1019 @@
+#include "core/gameboy/GB_Jit.h"
+
+#include "core/gameboy/GB_CPU.h"
+#include "core/gameboy/GB_MMU.h"
+#include "core/gameboy/GB_Scheduler.h"
+#include "core/gameboy/GB_Interrupts.h"
+#include "utils/Logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+// Registres x86 8 bits encodables sans préfixe REX (les octets hauts AH..BH
+// ne le sont qu'ainsi : r8-r15 ne servent jamais avec eux dans une instruction)
+enum Reg8 : uint8_t { AL = 0, CL = 1, DL = 2, BL = 3, AH = 4, CH = 5, DH = 6, BH = 7 };
+enum Reg16 : uint8_t { CX = 1, DX = 2, BX = 3, SI = 6 };
+
+// Index r des opcodes SM83 : B C D E H L (HL) A
+constexpr uint8_t REG8[8] = {BH, BL, DH, DL, CH, CL, 0xFF, AH};
+// Paires rp : BC DE HL SP
+constexpr uint8_t REG16[4] = {BX, DX, CX, SI};
+// Octets bas/haut des paires BC DE HL (PUSH/POP)
+constexpr uint8_t PAIR_LO[3] = {BL, DL, CL};
+constexpr uint8_t PAIR_HI[3] = {BH, DH, CH};
+
+// Opérations ALU x86 (forme r/m8, r8) dans l'ordre des opérations SM83 :
+// ADD ADC SUB SBC AND XOR OR CP
+constexpr uint8_t ALU_OPS[8] = {0x00, 0x10, 0x28, 0x18, 0x20, 0x30, 0x08, 0x38};
+
+// Conditions des sauts (second octet de 0F 8x)
+constexpr uint8_t JZ = 0x84;
+constexpr uint8_t JNZ = 0x85;
+constexpr uint8_t JBE = 0x86;
+constexpr uint8_t JMP = 0xFF;
+constexpr uint8_t NEVER = 0x00;
+
+constexpr uint32_t NO_LABEL = ~0u;
+
+// Base des tables de pages dans le code natif : r13 en lecture, r14 en écriture
+constexpr uint8_t READ_TABLE = 5;
+constexpr uint8_t WRITE_TABLE = 6;
+
+} // namespace
+
+GB_Jit::GB_Jit(GB_CPU& cpu, GB_MMU& mmu) : cpu(cpu), mmu(mmu) {
+    offA = offsetOf(&cpu.a);
+    offBC = offsetOf(&cpu.bc);
+    offDE = offsetOf(&cpu.de);
+    offHL = offsetOf(&cpu.hl);
+    offSP = offsetOf(&cpu.sp);
+    offPC = offsetOf(&cpu.pc);
+    offLazy = offsetOf(&cpu.lazy.op);
+    offLazyLhs = offsetOf(&cpu.lazy.lhs);
+    offLazyRhs = offsetOf(&cpu.lazy.rhs);
+    offLazyCarry = offsetOf(&cpu.lazy.carry);
+    offLazyResult = offsetOf(&cpu.lazy.result);
+    offBudget = offsetOf(&cpu.jitState.budget);
+    offReadPages = offsetOf(&cpu.jitState.readPages);
+    offWritePages = offsetOf(&cpu.jitState.writePages);
+    offHRAM = offsetOf(&cpu.jitState.hram);
+    offBailout = offsetOf(&cpu.jitState.bailout);
+    offBailoutChecked = offsetOf(&cpu.jitState.bailoutChecked);
+    offLoadCarry = offsetOf(&cpu.jitState.loadCarry);
+    offIdleLoop = offsetOf(&cpu.jitState.idleLoop);
+    offCarry = offsetOf(&cpu.jitState.carry);
+    offCounted = offsetOf(&cpu.jitState.counted);
+    offCycles = offsetOf(&cpu.cycles);
+
+    // Les flags paresseux sont écrits d'un bloc de 4 octets (op, lhs, rhs, carry)
+    if (offLazyLhs != offLazy + 1 || offLazyRhs != offLazy + 2 || offLazyCarry != offLazy + 3) {
+        LOG_ERROR("JIT disabled: unexpected LazyFlags layout");
+        return;
+    }
+
+    // Jamais inscriptible et exécutable à la fois : les pages passent en
+    // lecture/exécution une fois le bloc écrit (setWritable)
+    const long systemPage = sysconf(_SC_PAGESIZE);
+    if (systemPage > 0) pageSize = static_cast<size_t>(systemPage);
+
+    void* mapping = mmap(nullptr, CODE_CACHE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        LOG_WARN("JIT disabled: cannot map {} KB of code cache", CODE_CACHE_SIZE / 1024);
+        return;
+    }
+    codeBase = static_cast<uint8_t*>(mapping);
+    LOG_INFO("GB JIT enabled ({} KB code cache)", CODE_CACHE_SIZE / 1024);
+}
+
+GB_Jit::~GB_Jit() {
+    if (codeBase) munmap(codeBase, CODE_CACHE_SIZE);
+    if (perfMap) std::fclose(perfMap);
+}
+
+int32_t GB_Jit::offsetOf(const void* field) const {
+    return static_cast<int32_t>(static_cast<const char*>(field) - reinterpret_cast<const char*>(&cpu));
+}
+
+bool GB_Jit::setWritable(uint8_t* begin, size_t size, bool writable) {
+    const uintptr_t mask = ~static_cast<uintptr_t>(pageSize - 1);
+    const uintptr_t first = reinterpret_cast<uintptr_t>(begin) & mask;
+    const uintptr_t last = (reinterpret_cast<uintptr_t>(begin) + size + pageSize - 1) & mask;
+
+    const int protection = writable ? (PROT_READ | PROT_WRITE) : (PROT_READ | PROT_EXEC);
+    if (mprotect(reinterpret_cast<void*>(first), last - first, protection) != 0) {
+        LOG_ERROR("JIT: mprotect failed on the code cache");
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Bloc natif
+// ============================================================================
+
+GB_Jit::NativeBlock GB_Jit::compile(uint16_t start, uint16_t count, const ChainTable& chain, const uint8_t*& body) {
+    body = nullptr;
+    if (!codeBase) return nullptr;
+
+    buffer.clear();
+    labels.clear();
+    fixups.clear();
+    slowPaths.clear();
+    checks.clear();
+    exits.clear();
+
+    exitPC = newLabel();
+    exitNoPC = newLabel();
+    exitSpilled = newLabel();
+
+    prologue();
+    const size_t bodyOffset = buffer.size();
+
+    carry = Carry::Unknown;
+    lazyKnown = false;
+    pending = 0;
+    elapsed = 0;
+    blockStart = start;
+    chainTable = &chain;
+    uint16_t addr = start;
+    bool terminated = false;
+
+    for (uint16_t i = 0; i < count; ++i) {
+        Instruction ins{};
+        ins.addr = addr;
+        ins.opcode = mmu.read(addr);
+        ins.cb = (ins.opcode == 0xCB) ? mmu.read(addr + 1) : 0;
+        ins.imm8 = mmu.read(addr + 1);
+        ins.imm16 = static_cast<uint16_t>(ins.imm8 | (mmu.read(addr + 2) << 8));
+
+        // EI, HALT et STOP changent ce que runBlock vérifie entre deux blocs
+        if (ins.opcode == 0xFB || ins.opcode == 0x76 || ins.opcode == 0x10) chainTable = nullptr;
+
+        const uint8_t maxCycles = GB_CPU::maxInstructionCycles(ins.opcode, ins.cb);
+        const uint32_t check = newLabel();
+        emitBudgetCheck(elapsed + maxCycles, check);
+
+        const uint32_t slow = newLabel();
+        const uint32_t resume = newLabel();
+        const size_t fixupCount = fixups.size();
+        const uint16_t before = pending;
+        const Carry carryBefore = carry;
+        const bool last = GB_CPU::endsBlock(ins.opcode);
+        bool setsCarry = false;
+        if (emitInstruction(ins, slow)) {
+            // Quand le handler remplace le code natif, c'est lui qui doit
+            // remplir JitState::carry si le code natif l'aurait fait
+            setsCarry = (carry == Carry::Slot) && (carryBefore != Carry::Slot || isArithmetic(ins.opcode));
+
+            // Chemin rapide raté (page hors table, code protégé) : handler
+            bool usesSlow = false;
+            for (size_t f = fixupCount; f < fixups.size(); ++f) usesSlow |= (fixups[f].label == slow);
+            if (usesSlow) {
+                slowPaths.push_back({slow, resume, handlerKey(ins), pending, nativeCycles(ins.opcode, ins.cb),
+                                     GB_CPU::writesMemory(ins.opcode, ins.cb), setsCarry});
+            }
+            pending += nativeCycles(ins.opcode, ins.cb);
+        } else {
+            uint32_t stop = NO_LABEL;
+            if (!last && GB_CPU::writesMemory(ins.opcode, ins.cb)) stop = newStopExit(0);
+            emitHandlerCall(ins, stop);
+            pending = 0;
+            carry = Carry::Unknown;
+            lazyKnown = false;
+        }
+        // Un saut natif sort du bloc lui-même : la suite n'est atteinte
+        // qu'après son handler (chemin lent ou budget)
+        terminated = last;
+        bind(resume);
+
+        elapsed += maxCycles;
+        // Budget insuffisant : l'instruction passe par son handler, qui fait
+        // avancer l'horloge et les événements, puis le bloc continue
+        checks.push_back({check, resume, handlerKey(ins), before, pending, elapsed, setsCarry});
+        addr = static_cast<uint16_t>(addr + GB_CPU::instructionLength(ins.opcode));
+    }
+
+    // Fin du bloc : après le handler d'un saut, PC est déjà à jour
+    emit8(0x41); emit8(0xB9); emit32(static_cast<uint32_t>(pending) << 16);  // mov r9d, imm32
+    if (terminated) {
+        jump(JMP, exitNoPC);
+    } else {
+        emitChain(addr, pending, elapsed);
+        emit8(0x41); emit8(0xBA); emit32(addr);  // mov r10d, imm32
+        jump(JMP, exitPC);
+    }
+
+    // Chemins lents, hors du flux principal : le handler compte les cycles de
+    // l'instruction, qui restent dans pending pour les sorties suivantes
+    for (const SlowPath& path : slowPaths) {
+        const uint16_t counted = path.pending + path.cycles;
+        bind(path.label);
+        emitBailout(path.op, path.pending, counted, path.carry, path.writes ? newStopExit(counted) : NO_LABEL);
+        jump(JMP, path.resume);
+    }
+
+    for (const Check& check : checks) {
+        bind(check.label);
+        emitCheckedBailout(check);
+    }
+
+    emitExits();
+    resolveFixups();
+
+    // Cache plein : on repart de zéro, les blocs de l'époque précédente seront recompilés
+    if (codeUsed + buffer.size() > CODE_CACHE_SIZE) {
+        if (buffer.size() > CODE_CACHE_SIZE) return nullptr;
+        codeUsed = 0;
+        epoch++;
+        LOG_DEBUG("JIT code cache flushed");
+    }
+
+    // Les pages touchées ne sont inscriptibles que le temps de la copie
+    uint8_t* code = codeBase + codeUsed;
+    if (!setWritable(code, buffer.size(), true)) return nullptr;
+    std::memcpy(code, buffer.data(), buffer.size());
+    if (!setWritable(code, buffer.size(), false)) return nullptr;
+    codeUsed = (codeUsed + buffer.size() + 15) & ~static_cast<size_t>(15);
+
+    writePerfMap(code, buffer.size(), start);
+    body = code + bodyOffset;
+    return reinterpret_cast<NativeBlock>(code);
+}
+
+uint32_t GB_Jit::handlerKey(const Instruction& ins) {
+    const bool cb = ins.opcode == 0xCB;
+    const uint32_t next = static_cast<uint16_t>(ins.addr + (cb ? 2 : 1));
+    return next | ((cb ? 0x100u + ins.cb : ins.opcode) << 16);
+}
+
+bool GB_Jit::runHandler(GB_CPU* cpu, uint32_t op, uint32_t pending, uint32_t counted) {
+    GB_CPU::JitState& state = cpu->jitState;
+    const uint32_t opcode = op >> 16;
+
+    // Même séquence que GB_CPU::executeBlock
+    if (pending > state.counted) cpu->addCycles(static_cast<int>(pending - state.counted));
+    state.counted = counted;
+    cpu->pc = static_cast<uint16_t>(op);
+    cpu->addCycles(4);
+    if (opcode < 0x100) {
+        (cpu->*GB_CPU::opTable[opcode])();
+        return GB_CPU::writesMemory(static_cast<uint8_t>(opcode), 0);
+    }
+    (cpu->*GB_CPU::cbTable[opcode & 0xFF])();
+    return GB_CPU::writesMemory(0xCB, static_cast<uint8_t>(opcode));
+}
+
+uint32_t GB_Jit::bailout(GB_CPU* cpu, uint32_t op, uint32_t pending, uint32_t counted, uint32_t carry) {
+    // Le budget garantit qu'aucun événement ne tombe avant la fin de l'instruction
+    const bool writes = runHandler(cpu, op, pending, counted);
+    if (carry) loadCarry(cpu);
+    return (writes && cpu->jitMustStop()) ? 1 : 0;
+}
+
+uint32_t GB_Jit::bailoutChecked(GB_CPU* cpu, uint32_t op, uint32_t pending, uint32_t counted, uint32_t elapsed,
+                                uint32_t carry) {
+    GB_CPU::JitState& state = cpu->jitState;
+    runHandler(cpu, op, pending, counted);
+    if (carry) loadCarry(cpu);
+
+    // Les événements échus ont été traités par addCycles : nouveau budget
+    // jusqu'au suivant, en gardant la borne des cycles déjà écoulés du bloc
+    if (cpu->mmu.getCodeGeneration() != state.generation) return 1;
+    if (cpu->ime && cpu->interrupts.getPending()) return 1;
+
+    const uint64_t now = cpu->scheduler.now();
+    state.limit = std::min(state.until, cpu->scheduler.nextEventTime());
+    if (state.limit <= now) return 1;
+    state.budget = state.limit - now + elapsed;
+    return 0;
+}
+
+void GB_Jit::loadCarry(GB_CPU* cpu) {
+    cpu->jitState.carry = cpu->getCarry();
+}
+
+uint32_t GB_Jit::idleLoop(GB_CPU* cpu, uint32_t branch, uint32_t pending) {
+    // Saut arrière natif : même détection que les handlers de JR/JP, l'horloge à jour
+    GB_CPU::JitState& state = cpu->jitState;
+    if (pending > state.counted) cpu->addCycles(static_cast<int>(pending - state.counted));
+    state.counted = pending;
+
+    const uint64_t before = cpu->scheduler.now();
+    cpu->checkIdleLoop(static_cast<uint16_t>(branch));
+    return cpu->scheduler.now() != before ? 1 : 0;
+}
+
+void GB_Jit::writePerfMap(const uint8_t* code, size_t size, uint16_t start) {
+    if (!perfMap) {
+        const std::string path = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+        perfMap = std::fopen(path.c_str(), "a");
+        if (!perfMap) {
+            LOG_WARN("Cannot open perf map {}", path);
+            return;
+        }
+    }
+
+    // Nom : banque ROM et adresse, ou adresse en RAM
+    const uint32_t page = mmu.getCodePage(start);
+    if (start < 0x8000 && page != GB_MMU::NO_CODE_PAGE) {
+        std::fprintf(perfMap, "%lx %zx gb_rom%03x_%04x\n", reinterpret_cast<unsigned long>(code), size,
+                     page / 0x40, start);
+    } else {
+        std::fprintf(perfMap, "%lx %zx gb_ram_%04x\n", reinterpret_cast<unsigned long>(code), size, start);
+    }
+    std::fflush(perfMap);
+}
+
+// ============================================================================
+// Émission
+// ============================================================================
+
+void GB_Jit::emit16(uint16_t value) {
+    emit8(value & 0xFF);
+    emit8(value >> 8);
+}
+
+void GB_Jit::emit32(uint32_t value) {
+    for (int i = 0; i < 4; ++i) emit8((value >> (i * 8)) & 0xFF);
+}
+
+void GB_Jit::emit64(uint64_t value) {
+    for (int i = 0; i < 8; ++i) emit8((value >> (i * 8)) & 0xFF);
+}
+
+uint32_t GB_Jit::newLabel() {
+    labels.push_back(SIZE_MAX);
+    return static_cast<uint32_t>(labels.size() - 1);
+}
+
+void GB_Jit::bind(uint32_t label) {
+    labels[label] = buffer.size();
+}
+
+void GB_Jit::jump(uint8_t condition, uint32_t label) {
+    if (condition == JMP) {
+        emit8(0xE9);
+    } else {
+        emit8(0x0F);
+        emit8(condition);
+    }
+    fixups.push_back({buffer.size(), label});
+    emit32(0);
+}
+
+void GB_Jit::resolveFixups() {
+    for (const Fixup& fixup : fixups) {
+        const int32_t rel = static_cast<int32_t>(labels[fixup.label] - (fixup.at + 4));
+        std::memcpy(&buffer[fixup.at], &rel, 4);
+    }
+}
+
+void GB_Jit::prologue() {
+    // Registres préservés (System V) : rbx, rbp, r12-r15, pile alignée sur 16
+    emit8(0x53);                               // push rbx
+    emit8(0x55);                               // push rbp
+    emit8(0x41); emit8(0x54);                  // push r12
+    emit8(0x41); emit8(0x55);                  // push r13
+    emit8(0x41); emit8(0x56);                  // push r14
+    emit8(0x41); emit8(0x57);                  // push r15
+    emit8(0x48); emit8(0x83); emit8(0xEC); emit8(0x08);  // sub rsp, 8
+    emit8(0x48); emit8(0x89); emit8(0xFD);     // mov rbp, rdi
+
+    emit8(0x4C); emit8(0x8B); emit8(0xA5); emitDisp(offBudget);      // mov r12, [rbp+budget]
+    emit8(0x4C); emit8(0x8B); emit8(0xAD); emitDisp(offReadPages);   // mov r13, [rbp+readPages]
+    emit8(0x4C); emit8(0x8B); emit8(0xB5); emitDisp(offWritePages);  // mov r14, [rbp+writePages]
+    emit8(0x4C); emit8(0x8B); emit8(0xBD); emitDisp(offHRAM);        // mov r15, [rbp+hram]
+    reload();
+}
+
+void GB_Jit::epilogue() {
+    emit8(0x44); emit8(0x89); emit8(0xC8);     // mov eax, r9d
+    emit8(0x48); emit8(0x83); emit8(0xC4); emit8(0x08);  // add rsp, 8
+    emit8(0x41); emit8(0x5F);                  // pop r15
+    emit8(0x41); emit8(0x5E);                  // pop r14
+    emit8(0x41); emit8(0x5D);                  // pop r13
+    emit8(0x41); emit8(0x5C);                  // pop r12
+    emit8(0x5D);                               // pop rbp
+    emit8(0x5B);                               // pop rbx
+    emit8(0xC3);                               // ret
+}
+
+void GB_Jit::spill() {
+    emit8(0x88); emit8(0xA5); emitDisp(offA);                  // mov [rbp+a], ah
+    emit8(0x66); emit8(0x89); emit8(0x9D); emitDisp(offBC);    // mov [rbp+bc], bx
+    emit8(0x66); emit8(0x89); emit8(0x95); emitDisp(offDE);    // mov [rbp+de], dx
+    emit8(0x66); emit8(0x89); emit8(0x8D); emitDisp(offHL);    // mov [rbp+hl], cx
+    emit8(0x66); emit8(0x89); emit8(0xB5); emitDisp(offSP);    // mov [rbp+sp], si
+}
+
+void GB_Jit::reload() {
+    // Que des mov : les flags x86 d'avant sont conservés
+    emit8(0x8A); emit8(0xA5); emitDisp(offA);
+    emit8(0x66); emit8(0x8B); emit8(0x9D); emitDisp(offBC);
+    emit8(0x66); emit8(0x8B); emit8(0x95); emitDisp(offDE);
+    emit8(0x66); emit8(0x8B); emit8(0x8D); emitDisp(offHL);
+    emit8(0x66); emit8(0x8B); emit8(0xB5); emitDisp(offSP);
+}
+
+void GB_Jit::emitBudgetCheck(uint32_t maxElapsed, uint32_t check) {
+    // Chemin vérifié si budget <= borne haute des cycles à la fin de l'instruction
+    emit8(0x49); emit8(0x81); emit8(0xFC); emit32(maxElapsed);  // cmp r12, imm32
+    jump(JBE, check);
+}
+
+uint32_t GB_Jit::newStopExit(uint16_t counted) {
+    const uint32_t exit = newLabel();
+    exits.push_back({exit, (static_cast<uint32_t>(counted) << 16) | RESULT_STOP});
+    return exit;
+}
+
+void GB_Jit::emitBailout(uint32_t op, uint16_t pending, uint16_t counted, bool carry, uint32_t stop) {
+    spill();
+    emit8(0x48); emit8(0x89); emit8(0xEF);                    // mov rdi, rbp
+    emit8(0xBE); emit32(op);                                  // mov esi, op
+    emit8(0xBA); emit32(pending);                             // mov edx, pending
+    emit8(0xB9); emit32(counted);                             // mov ecx, counted
+    emit8(0x41); emit8(0xB8); emit32(carry);                  // mov r8d, carry
+    emit8(0xFF); emit8(0x95); emitDisp(offBailout);           // call [rbp+bailout]
+    emit8(0x85); emit8(0xC0);                                 // test eax, eax
+    reload();
+    if (stop != NO_LABEL) jump(JNZ, stop);
+}
+
+void GB_Jit::emitHandlerCall(const Instruction& ins, uint32_t stop) {
+    // Appel direct du handler (GB_CPU::jitOp) : cycles natifs en attente,
+    // moins ceux déjà comptés par un chemin lent, plus la lecture de l'opcode
+    const bool cb = ins.opcode == 0xCB;
+    const GB_CPU::JitHandler handler = cb ? GB_CPU::jitCBTable[ins.cb] : GB_CPU::jitOpTable[ins.opcode];
+    spill();
+    emit8(0xBA); emit32(pending + 4u);                        // mov edx, pending + 4
+    emit8(0x2B); emit8(0x95); emitDisp(offCounted);           // sub edx, [rbp+counted]
+    emit8(0xC7); emit8(0x85); emitDisp(offCounted); emit32(0); // mov dword [rbp+counted], 0
+    emit8(0xBE); emit32(ins.addr + (cb ? 2u : 1u));           // mov esi, next
+    emit8(0x48); emit8(0x89); emit8(0xEF);                    // mov rdi, rbp
+    emit8(0x48); emit8(0xB8); emit64(reinterpret_cast<uint64_t>(handler));  // mov rax, imm64
+    emit8(0xFF); emit8(0xD0);                                 // call rax
+    emit8(0x85); emit8(0xC0);                                 // test eax, eax
+    reload();
+    if (stop != NO_LABEL) jump(JNZ, stop);
+}
+
+void GB_Jit::emitCheckedBailout(const Check& check) {
+    // Le handler exécute l'instruction à la place du code natif ; le budget
+    // est recalculé par bailoutChecked, r12 est relu
+    spill();
+    emit8(0x48); emit8(0x89); emit8(0xEF);                    // mov rdi, rbp
+    emit8(0xBE); emit32(check.op);                            // mov esi, op
+    emit8(0xBA); emit32(check.pending);                       // mov edx, pending
+    emit8(0xB9); emit32(check.counted);                       // mov ecx, counted
+    emit8(0x41); emit8(0xB8); emit32(check.elapsed);          // mov r8d, elapsed
+    emit8(0x41); emit8(0xB9); emit32(check.carry);            // mov r9d, carry
+    emit8(0xFF); emit8(0x95); emitDisp(offBailoutChecked);    // call [rbp+bailoutChecked]
+    emit8(0x85); emit8(0xC0);                                 // test eax, eax
+    reload();
+    emit8(0x4C); emit8(0x8B); emit8(0xA5); emitDisp(offBudget);  // mov r12, [rbp+budget]
+    jump(JNZ, newStopExit(check.counted));
+    jump(JMP, check.resume);
+}
+
+void GB_Jit::emitLoadCarry() {
+    // C inconnu (après un handler) : calculé depuis les flags paresseux
+    if (carry != Carry::Unknown) return;
+    spill();
+    emit8(0x48); emit8(0x89); emit8(0xEF);                    // mov rdi, rbp
+    emit8(0xFF); emit8(0x95); emitDisp(offLoadCarry);         // call [rbp+loadCarry]
+    reload();
+    carry = Carry::Slot;
+}
+
+void GB_Jit::emitExits() {
+    // Arrêt après un handler : PC déjà à jour
+    for (const Exit& exit : exits) {
+        bind(exit.label);
+        emit8(0x41); emit8(0xB9); emit32(exit.result);        // mov r9d, result
+        jump(JMP, exitNoPC);
+    }
+
+    bind(exitPC);
+    spill();
+    emit8(0x66); emit8(0x44); emit8(0x89); emit8(0x95); emitDisp(offPC);  // mov [rbp+pc], r10w
+    epilogue();
+
+    bind(exitNoPC);
+    spill();
+    bind(exitSpilled);
+    epilogue();
+}
+
+// ============================================================================
+// Instructions
+// ============================================================================
+
+bool GB_Jit::emitInstruction(const Instruction& ins, uint32_t slow) {
+    // Faux : rien n'est émis, l'instruction passe par son handler
+    const uint8_t opcode = ins.opcode;
+    const uint8_t x = opcode >> 6;
+    const uint8_t y = (opcode >> 3) & 0x07;
+    const uint8_t z = opcode & 0x07;
+
+    if (opcode == 0xCB) {
+        // RES b, r / SET b, r : ni flags ni mémoire
+        const uint8_t cbx = ins.cb >> 6;
+        const uint8_t reg = REG8[ins.cb & 0x07];
+        if (cbx < 2 || reg == 0xFF) return false;
+        const uint8_t mask = 1 << ((ins.cb >> 3) & 0x07);
+        emit8(0x80);
+        if (cbx == 2) {
+            emit8(0xE0 | reg); emit8(static_cast<uint8_t>(~mask));  // and r8, ~mask
+        } else {
+            emit8(0xC8 | reg); emit8(mask);                         // or r8, mask
+        }
+        return true;
+    }
+
+    if (x == 1) {
+        if (opcode == 0x76) return false;  // HALT
+        if (z == 6) {                      // LD r, (HL)
+            emitPagePointer(CX, false, slow);
+            emit8(0x8A); emit8(0x07 | (REG8[y] << 3));
+        } else if (y == 6) {               // LD (HL), r
+            emitPagePointer(CX, true, slow);
+            emit8(0x88); emit8(0x07 | (REG8[z] << 3));
+        } else if (y != z) {               // LD r, r'
+            emit8(0x88); emit8(0xC0 | (REG8[z] << 3) | REG8[y]);
+        }
+        return true;
+    }
+
+    if (x == 2) {
+        if (z == 6) {                      // ALU A, (HL)
+            if (y == 1 || y == 3) return false;
+            emitPagePointer(CX, false, slow);
+            emit8(0x8A); emit8(0x07);      // mov al, [rdi]
+            emitALU(y, AL, false, 0);
+        } else {
+            emitALU(y, REG8[z], false, 0);
+        }
+        return true;
+    }
+
+    if (x == 0) {
+        switch (z) {
+            case 0:
+                if (opcode == 0x18) return emitJR(ins, 0xFF, slow);       // JR e
+                if (y >= 4) return emitJR(ins, y - 4, slow);              // JR cc, e
+                return opcode == 0x00;     // NOP
+            case 1:
+                if (y & 1) return false;   // ADD HL, rr
+                emit8(0x66); emit8(0xB8 + REG16[y >> 1]); emit16(ins.imm16);  // mov r16, imm16
+                return true;
+            case 2: {
+                // LD (BC)/(DE)/(HL+)/(HL-), A et LD A, (BC)/(DE)/(HL+)/(HL-)
+                const uint8_t p = y >> 1;
+                const bool load = y & 1;
+                emitPagePointer(REG16[p < 2 ? p : 2], !load, slow);
+                emit8(load ? 0x8A : 0x88); emit8(0x27);  // mov ah, [rdi] / mov [rdi], ah
+                if (p == 2) { emit8(0x66); emit8(0xFF); emit8(0xC1); }  // inc cx
+                if (p == 3) { emit8(0x66); emit8(0xFF); emit8(0xC9); }  // dec cx
+                return true;
+            }
+            case 3:                        // INC rr / DEC rr
+                emit8(0x66); emit8(0xFF); emit8(((y & 1) ? 0xC8 : 0xC0) | REG16[y >> 1]);
+                return true;
+            case 4:
+            case 5:
+                if (y == 6) return false;  // INC/DEC (HL)
+                emitIncDec(REG8[y], z == 5);
+                return true;
+            case 6:
+                if (y == 6) {              // LD (HL), n
+                    emitPagePointer(CX, true, slow);
+                    emit8(0xC6); emit8(0x07); emit8(ins.imm8);
+                } else {                   // LD r, n
+                    emit8(0xB0 + REG8[y]); emit8(ins.imm8);
+                }
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // x == 3
+    switch (opcode) {
+        case 0xE0: return emitConstStoreA(0xFF00 | ins.imm8, slow);  // LDH (n), A
+        case 0xF0: return emitConstLoadA(0xFF00 | ins.imm8, slow);   // LDH A, (n)
+        case 0xEA: return emitConstStoreA(ins.imm16, slow);          // LD (nn), A
+        case 0xFA: return emitConstLoadA(ins.imm16, slow);           // LD A, (nn)
+        case 0xF9:                                                   // LD SP, HL
+            emit8(0x66); emit8(0x89); emit8(0xCE);
+            return true;
+        case 0xC3: return emitJP(ins, 0xFF, slow);                   // JP nn
+        case 0xCD: return emitCall(ins, 0xFF, slow);                 // CALL nn
+        case 0xC9: return emitRet(ins, 0xFF, slow);                  // RET
+        case 0xE9:                                                   // JP (HL)
+            emit8(0x44); emit8(0x0F); emit8(0xB7); emit8(0xD1);      // movzx r10d, cx
+            emit8(0x41); emit8(0xB9); emit32((pending + 8u) << 16);  // mov r9d, imm32
+            jump(JMP, exitPC);
+            return true;
+        default:
+            break;
+    }
+    if (z == 6) {                          // ALU A, n
+        emitALU(y, 0, true, ins.imm8);
+        return true;
+    }
+    if (y < 4) {                           // RET cc / JP cc / CALL cc
+        if (z == 0) return emitRet(ins, y, slow);
+        if (z == 2) return emitJP(ins, y, slow);
+        if (z == 4) return emitCall(ins, y, slow);
+    }
+    if (z == 7) return emitCall(ins, 0xFF, slow);                    // RST
+    if (z == 5 && !(y & 1) && y < 6) return emitPush(y >> 1, slow);  // PUSH BC/DE/HL
+    if (z == 1 && !(y & 1) && y < 6) return emitPop(y >> 1, slow);   // POP BC/DE/HL
+    return false;
+}
+
+template<typename Taken, typename NotTaken>
+void GB_Jit::emitBranch(uint8_t condition, Taken taken, NotTaken notTaken) {
+    if (condition == JMP) {
+        taken();
+    } else if (condition == NEVER) {
+        notTaken();
+    } else {
+        const uint32_t label = newLabel();
+        jump(condition, label);
+        notTaken();
+        bind(label);
+        taken();
+    }
+}
+
+uint8_t GB_Jit::emitCondition(uint8_t cc, uint32_t slow) {
+    // Rend le saut x86 pris quand la condition SM83 est vraie (JMP : toujours,
+    // NEVER : jamais). Z vaut résultat == 0 pour toute opération paresseuse ;
+    // après un handler qui a calculé F, chemin lent
+    if (cc == 0xFF) return JMP;
+    if (cc < 2) {
+        if (!lazyKnown) {
+            emit8(0x80); emit8(0xBD); emitDisp(offLazy); emit8(0x00);        // cmp byte [lazy.op], 0
+            jump(JZ, slow);
+        }
+        emit8(0x80); emit8(0xBD); emitDisp(offLazyResult); emit8(0x00);      // cmp byte [lazy.result], 0
+        return (cc == 0) ? JNZ : JZ;
+    }
+    if (carry == Carry::Zero) return (cc == 2) ? JMP : NEVER;
+    if (carry == Carry::One) return (cc == 2) ? NEVER : JMP;
+    emitLoadCarry();
+    emit8(0x80); emit8(0xBD); emitDisp(offCarry); emit8(0x00);               // cmp byte [carry], 0
+    return (cc == 2) ? JZ : JNZ;
+}
+
+void GB_Jit::emitJumpExit(uint16_t target, uint8_t cycles, bool loop, uint16_t branch) {
+    const uint32_t total = pending + cycles;
+    if (loop && target <= branch) {
+        // Saut arrière : détection des boucles d'attente avant de sortir
+        spill();
+        emit8(0x66); emit8(0xC7); emit8(0x85); emitDisp(offPC); emit16(target);  // mov word [rbp+pc], imm16
+        emit8(0x48); emit8(0x89); emit8(0xEF);                                 // mov rdi, rbp
+        emit8(0xBE); emit32(branch);                                           // mov esi, branch
+        emit8(0xBA); emit32(total);                                            // mov edx, total
+        emit8(0xFF); emit8(0x95); emitDisp(offIdleLoop);                       // call [rbp+idleLoop]
+        emit8(0x41); emit8(0xB9); emit32(total << 16);                         // mov r9d, imm32
+        if (!chainTable) {
+            jump(JMP, exitSpilled);
+            return;
+        }
+        // Cycles sautés : l'horloge a dépassé la borne du budget
+        emit8(0x85); emit8(0xC0);                                              // test eax, eax
+        jump(JNZ, exitSpilled);
+        reload();
+    }
+    emitChain(target, total, elapsed + cycles);
+    emit8(0x41); emit8(0xB9); emit32(total << 16);                             // mov r9d, imm32
+    emit8(0x41); emit8(0xBA); emit32(target);                                  // mov r10d, imm32
+    jump(JMP, exitPC);
+}
+
+void GB_Jit::emitChain(uint16_t target, uint32_t total, uint32_t bound) {
+    // Bloc cible compilé dans la même page : même banque, même durée de vie.
+    // Le budget vérifié avant le saut couvre bound, donc l'horloge avancée
+    // ici reste avant le prochain événement
+    if (!chainTable || (target & 0xFF00) != (blockStart & 0xFF00)) return;
+
+    const uint32_t miss = newLabel();
+    emit8(0x48); emit8(0xBF); emit64(reinterpret_cast<uint64_t>(&(*chainTable)[target & 0xFF]));  // mov rdi, imm64
+    emit8(0x4C); emit8(0x8B); emit8(0x1F);                                     // mov r11, [rdi]
+    emit8(0x4D); emit8(0x85); emit8(0xDB);                                     // test r11, r11
+    jump(JZ, miss);
+
+    emit8(0x49); emit8(0x81); emit8(0xEC); emit32(bound);                      // sub r12, bound
+    emit8(0x41); emit8(0xB8); emit32(total);                                   // mov r8d, total
+    emit8(0x44); emit8(0x2B); emit8(0x85); emitDisp(offCounted);               // sub r8d, [rbp+counted]
+    emit8(0xC7); emit8(0x85); emitDisp(offCounted); emit32(0);                 // mov dword [rbp+counted], 0
+    emit8(0x44); emit8(0x01); emit8(0x85); emitDisp(offCycles);                // add [rbp+cycles], r8d
+    emit8(0x48); emit8(0xBF); emit64(reinterpret_cast<uint64_t>(&cpu.scheduler.timestamp));  // mov rdi, imm64
+    emit8(0x4C); emit8(0x01); emit8(0x07);                                     // add [rdi], r8
+    emit8(0x41); emit8(0xFF); emit8(0xE3);                                     // jmp r11
+    bind(miss);
+}
+
+bool GB_Jit::emitJR(const Instruction& ins, uint8_t cc, uint32_t slow) {
+    // Cycles des handlers, lecture de l'opcode comprise (JR : 16 pris, 12 sinon)
+    const uint16_t next = static_cast<uint16_t>(ins.addr + 2);
+    const uint16_t target = static_cast<uint16_t>(next + static_cast<int8_t>(ins.imm8));
+    const uint8_t taken = emitCondition(cc, slow);
+    emitBranch(taken, [&] { emitJumpExit(target, 16, true, ins.addr); },
+               [&] { emitJumpExit(next, 12, false, 0); });
+    return true;
+}
+
+bool GB_Jit::emitJP(const Instruction& ins, uint8_t cc, uint32_t slow) {
+    const uint16_t next = static_cast<uint16_t>(ins.addr + 3);
+    const uint8_t taken = emitCondition(cc, slow);
+    emitBranch(taken, [&] { emitJumpExit(ins.imm16, 20, true, ins.addr); },
+               [&] { emitJumpExit(next, 16, false, 0); });
+    return true;
+}
+
+bool GB_Jit::emitCall(const Instruction& ins, uint8_t cc, uint32_t slow) {
+    // CALL nn / CALL cc, nn / RST : adresse de retour empilée d'un bloc
+    const bool rst = (ins.opcode & 0x07) == 7;
+    const uint16_t next = static_cast<uint16_t>(ins.addr + (rst ? 1 : 3));
+    const uint16_t target = rst ? (ins.opcode & 0x38) : ins.imm16;
+    const uint8_t taken = emitCondition(cc, slow);
+    emitBranch(taken, [&] {
+        emitStackPointer(true, slow);
+        emit8(0x66); emit8(0xC7); emit8(0x07); emit16(next);     // mov word [rdi], imm16
+        emit8(0x66); emit8(0x83); emit8(0xEE); emit8(0x02);      // sub si, 2
+        emitJumpExit(target, rst ? 20 : 28, false, 0);
+    }, [&] { emitJumpExit(next, 16, false, 0); });
+    return true;
+}
+
+bool GB_Jit::emitRet(const Instruction& ins, uint8_t cc, uint32_t slow) {
+    const uint8_t taken = emitCondition(cc, slow);
+    emitBranch(taken, [&] {
+        emitStackPointer(false, slow);
+        emit8(0x44); emit8(0x0F); emit8(0xB7); emit8(0x17);      // movzx r10d, word [rdi]
+        emit8(0x66); emit8(0x83); emit8(0xC6); emit8(0x02);      // add si, 2
+        emit8(0x41); emit8(0xB9); emit32((pending + (cc == 0xFF ? 20u : 24u)) << 16);  // mov r9d, imm32
+        jump(JMP, exitPC);
+    }, [&] { emitJumpExit(static_cast<uint16_t>(ins.addr + 1), 12, false, 0); });
+    return true;
+}
+
+void GB_Jit::emitPagePointer(uint8_t addrReg, bool write, uint32_t slow) {
+    // rdi = page[addr & 0xFF] d'après la table de pages du MMU, sinon chemin lent
+    const uint8_t table = write ? WRITE_TABLE : READ_TABLE;
+    emit8(0x0F); emit8(0xB7); emit8(0xF8 | addrReg);                  // movzx edi, r16
+    emit8(0x41); emit8(0x89); emit8(0xF8);                            // mov r8d, edi
+    emit8(0x41); emit8(0xC1); emit8(0xE8); emit8(0x08);               // shr r8d, 8
+    emit8(0x81); emit8(0xE7); emit32(0xFF);                           // and edi, 0xFF
+    emit8(0x4F); emit8(0x8B); emit8(0x44); emit8(0xC0 | table); emit8(0x00);  // mov r8, [table + r8*8]
+    emit8(0x4D); emit8(0x85); emit8(0xC0);                            // test r8, r8
+    jump(JZ, slow);
+    emit8(0x4C); emit8(0x01); emit8(0xC7);                            // add rdi, r8
+}
+
+void GB_Jit::emitConstPagePointer(uint16_t addr, bool write, uint32_t slow) {
+    // rdi = début de la page, l'octet est adressé par [rdi + (addr & 0xFF)]
+    const uint8_t table = write ? WRITE_TABLE : READ_TABLE;
+    emit8(0x49); emit8(0x8B); emit8(0xB8 | table); emitDisp((addr >> 8) * 8);  // mov rdi, [table + page*8]
+    emit8(0x48); emit8(0x85); emit8(0xFF);                                   // test rdi, rdi
+    jump(JZ, slow);
+}
+
+bool GB_Jit::emitConstLoadA(uint16_t addr, uint32_t slow) {
+    if (addr >= 0xFF80 && addr != 0xFFFF) {
+        // HRAM : toujours lisible, même pendant une DMA
+        emit8(0x41); emit8(0x8A); emit8(0x87); emitDisp(addr - 0xFF80);  // mov al, [r15 + disp]
+        emit8(0x88); emit8(0xC4);                                        // mov ah, al
+        return true;
+    }
+    // I/O, OAM et IE : jamais dans la table de pages
+    if (addr >= 0xFE00) return false;
+
+    emitConstPagePointer(addr, false, slow);
+    emit8(0x8A); emit8(0xA7); emitDisp(addr & 0xFF);                     // mov ah, [rdi + disp]
+    return true;
+}
+
+bool GB_Jit::emitConstStoreA(uint16_t addr, uint32_t slow) {
+    if (addr >= 0xFF80 && addr != 0xFFFF) {
+        emitHRAMCodeCheck(slow);
+        emit8(0x88); emit8(0xE0);                                                // mov al, ah
+        emit8(0x41); emit8(0x88); emit8(0x87); emitDisp(addr - 0xFF80);          // mov [r15 + disp], al
+        return true;
+    }
+    // MBC, I/O, OAM et IE : toujours sur le chemin lent
+    if (addr < 0x8000 || addr >= 0xFE00) return false;
+
+    emitConstPagePointer(addr, true, slow);
+    emit8(0x88); emit8(0xA7); emitDisp(addr & 0xFF);                     // mov [rdi + disp], ah
+    return true;
+}
+
+void GB_Jit::emitALU(uint8_t kind, uint8_t src, bool immediate, uint8_t imm) {
+    const uint8_t base = ALU_OPS[kind];
+    lazyKnown = true;
+
+    // Même contenu de LazyFlags que GB_CPU::opALU
+    if (kind >= 4 && kind <= 6) {
+        if (immediate) {
+            emit8(0x80); emit8(0xC0 | base | AH); emit8(imm);   // op ah, imm8
+        } else {
+            emit8(base); emit8(0xC0 | (src << 3) | AH);         // op ah, r8
+        }
+        const auto op = (kind == 4) ? GB_CPU::FlagOp::And : GB_CPU::FlagOp::Or;
+        emit8(0xC7); emit8(0x85); emitDisp(offLazy); emit32(static_cast<uint8_t>(op));  // op, 0, 0, 0
+        emit8(0x88); emit8(0xA5); emitDisp(offLazyResult);                                // result = ah
+        carry = Carry::Zero;
+        return;
+    }
+
+    const bool compare = (kind == 7);
+    if (kind == 1 || kind == 3) emitLoadCarry();
+    const bool withCarry = (kind == 1 || kind == 3) && carry != Carry::Zero;
+    const auto op = (kind <= 1) ? GB_CPU::FlagOp::Add : GB_CPU::FlagOp::Sub;
+
+    emit8(0x88); emit8(0xA5); emitDisp(offLazyLhs);                       // lhs = ah
+    if (immediate) {
+        emit8(0xC6); emit8(0x85); emitDisp(offLazyRhs); emit8(imm);       // rhs = imm
+    } else {
+        emit8(0x88); emit8(0x85 | (src << 3)); emitDisp(offLazyRhs);      // rhs = r8
+    }
+    emit8(0xC6); emit8(0x85); emitDisp(offLazy); emit8(static_cast<uint8_t>(op));
+
+    // Retenue entrante dans CF juste avant l'opération
+    if (!withCarry) {
+        emit8(0xC6); emit8(0x85); emitDisp(offLazyCarry); emit8(0);
+    } else if (carry == Carry::One) {
+        emit8(0xC6); emit8(0x85); emitDisp(offLazyCarry); emit8(1);
+        emit8(0xF9);                                                      // stc
+    } else {
+        emit8(0x8A); emit8(0x85); emitDisp(offCarry);                     // mov al, [carry]
+        emit8(0x88); emit8(0x85); emitDisp(offLazyCarry);                 // mov [lazy.carry], al
+        emit8(0xD0); emit8(0xE8);                                         // shr al, 1
+    }
+
+    // ADD/ADC/SUB/SBC/CP : CF x86 = C du SM83 (retenue ou emprunt sur 8 bits)
+    uint8_t x86op = base;
+    if (!withCarry && kind == 1) x86op = ALU_OPS[0];
+    if (!withCarry && kind == 3) x86op = ALU_OPS[2];
+    if (immediate) {
+        emit8(0x80); emit8(0xC0 | x86op | AH); emit8(imm);
+    } else {
+        emit8(x86op); emit8(0xC0 | (src << 3) | AH);
+    }
+    emit8(0x0F); emit8(0x92); emit8(0x85); emitDisp(offCarry);           // setc [carry]
+    carry = Carry::Slot;
+
+    if (!compare) {
+        emit8(0x88); emit8(0xA5); emitDisp(offLazyResult);               // result = ah
+        return;
+    }
+
+    // CP : le résultat n'est gardé que dans LazyFlags
+    if (!immediate && src == AL) {
+        emit8(0xF6); emit8(0xD8);                                         // neg al
+        emit8(0x00); emit8(0xE0);                                         // add al, ah
+    } else {
+        emit8(0x88); emit8(0xE0);                                         // mov al, ah
+        if (immediate) {
+            emit8(0x80); emit8(0xE8); emit8(imm);                         // sub al, imm8
+        } else {
+            emit8(0x28); emit8(0xC0 | (src << 3));                        // sub al, r8
+        }
+    }
+    emit8(0x88); emit8(0x85); emitDisp(offLazyResult);                    // result = al
+}
+
+void GB_Jit::emitIncDec(uint8_t reg, bool dec) {
+    // INC/DEC gardent C : lazy = {Inc/Dec, 0, 0, C, résultat}
+    emitLoadCarry();
+    lazyKnown = true;
+    const auto op = dec ? GB_CPU::FlagOp::Dec : GB_CPU::FlagOp::Inc;
+    const uint32_t known = (carry == Carry::One) ? 1 : 0;
+    emit8(0xC7); emit8(0x85); emitDisp(offLazy); emit32(static_cast<uint8_t>(op) | (known << 24));
+    if (carry == Carry::Slot) {
+        emit8(0x8A); emit8(0x85); emitDisp(offCarry);                    // mov al, [carry]
+        emit8(0x88); emit8(0x85); emitDisp(offLazyCarry);                // mov [lazy.carry], al
+    }
+    emit8(0xFE); emit8((dec ? 0xC8 : 0xC0) | reg);                       // inc/dec r8
+    emit8(0x88); emit8(0x85 | (reg << 3)); emitDisp(offLazyResult);      // result = r8
+}
+
+void GB_Jit::emitStackPointer(bool push, uint32_t slow) {
+    // rdi = premier des deux octets de pile (SP - 2 pour empiler, SP pour
+    // dépiler), les deux dans la même page : table de pages ou HRAM
+    const uint32_t hram = newLabel();
+    const uint32_t done = newLabel();
+    emit8(0x0F); emit8(0xB7); emit8(0xFE);                            // movzx edi, si
+    emit8(0x44); emit8(0x8D); emit8(0x87); emitDisp(push ? -0xFF82 : -0xFF80);  // lea r8d, [rdi - base]
+    emit8(0x41); emit8(0x83); emit8(0xF8); emit8(0x7D);               // cmp r8d, 0x7D
+    jump(JBE, hram);
+
+    if (push) {
+        emit8(0xF7); emit8(0xC7); emit32(0xFE);                       // test edi, 0xFE
+        jump(JZ, slow);
+        emit8(0x83); emit8(0xEF); emit8(0x02);                        // sub edi, 2
+    } else {
+        emit8(0x40); emit8(0x80); emit8(0xFF); emit8(0xFF);           // cmp dil, 0xFF
+        jump(JZ, slow);
+    }
+    const uint8_t table = push ? WRITE_TABLE : READ_TABLE;
+    emit8(0x41); emit8(0x89); emit8(0xF8);                            // mov r8d, edi
+    emit8(0x41); emit8(0xC1); emit8(0xE8); emit8(0x08);               // shr r8d, 8
+    emit8(0x81); emit8(0xE7); emit32(0xFF);                           // and edi, 0xFF
+    emit8(0x4F); emit8(0x8B); emit8(0x44); emit8(0xC0 | table); emit8(0x00);  // mov r8, [table + r8*8]
+    emit8(0x4D); emit8(0x85); emit8(0xC0);                            // test r8, r8
+    jump(JZ, slow);
+    emit8(0x4C); emit8(0x01); emit8(0xC7);                            // add rdi, r8
+    jump(JMP, done);
+
+    // Pile en HRAM (SP = 0xFFFE au démarrage), IE exclu
+    bind(hram);
+    emit8(0x4B); emit8(0x8D); emit8(0x3C); emit8(0x07);               // lea rdi, [r15 + r8]
+    if (push) emitHRAMCodeCheck(slow);
+    bind(done);
+}
+
+void GB_Jit::emitHRAMCodeCheck(uint32_t slow) {
+    // Chemin lent si la HRAM contient du code en cache
+    const uint8_t* hramFlag = reinterpret_cast<const uint8_t*>(mmu.getCodePageBitmap()) + 0xFF / 8;
+    emit8(0x49); emit8(0xB8); emit64(reinterpret_cast<uint64_t>(hramFlag));  // mov r8, imm64
+    emit8(0x41); emit8(0xF6); emit8(0x00); emit8(0x80);                      // test byte [r8], 0x80
+    jump(JNZ, slow);
+}
+
+bool GB_Jit::emitPush(uint8_t pair, uint32_t slow) {
+    emitStackPointer(true, slow);
+    emit8(0x88); emit8(0x07 | (PAIR_LO[pair] << 3));                  // mov [rdi], lo
+    emit8(0x88); emit8(0x47 | (PAIR_HI[pair] << 3)); emit8(0x01);     // mov [rdi+1], hi
+    emit8(0x66); emit8(0x83); emit8(0xEE); emit8(0x02);               // sub si, 2
+    return true;
+}
+
+bool GB_Jit::emitPop(uint8_t pair, uint32_t slow) {
+    emitStackPointer(false, slow);
+    emit8(0x8A); emit8(0x07 | (PAIR_LO[pair] << 3));                  // mov lo, [rdi]
+    emit8(0x8A); emit8(0x47 | (PAIR_HI[pair] << 3)); emit8(0x01);     // mov hi, [rdi+1]
+    emit8(0x66); emit8(0x83); emit8(0xC6); emit8(0x02);               // add si, 2
+    return true;
+}
+
+bool GB_Jit::isArithmetic(uint8_t opcode) {
+    // ADD/ADC/SUB/SBC/CP, registre ou immédiat : écrivent JitState::carry
+    const uint8_t y = (opcode >> 3) & 0x07;
+    const bool alu = (opcode >> 6) == 2 || (opcode & 0xC7) == 0xC6;
+    return alu && (y < 4 || y == 7);
+}
+
+uint8_t GB_Jit::nativeCycles(uint8_t opcode, uint8_t cb) {
+    // Cycles comptés par l'interpréteur (lecture de l'opcode comprise) pour
+    // les instructions que emitInstruction sait émettre ; sauts : branche prise
+    const uint8_t x = opcode >> 6;
+    const uint8_t y = (opcode >> 3) & 0x07;
+    const uint8_t z = opcode & 0x07;
+
+    if (opcode == 0xCB) return ((cb & 0x07) == 6) ? 20 : 12;
+    if (x == 1) return (y == 6 || z == 6) ? 12 : 8;
+    if (x == 2) return (z == 6) ? 12 : 8;
+    if (x == 0) {
+        switch (z) {
+            case 1: return 16;
+            case 2: return 12;
+            case 3: return 12;
+            case 6: return (y == 6) ? 16 : 12;
+            case 4:
+            case 5: return 8;
+            default: return (y >= 3) ? 16 : 8;  // JR / NOP
+        }
+    }
+    switch (opcode) {
+        case 0xE0:
+        case 0xF0: return 16;
+        case 0xEA:
+        case 0xFA: return 20;
+        case 0xF9: return 12;
+        case 0xE9: return 8;           // JP (HL)
+        case 0xC3: return 20;          // JP nn
+        case 0xCD: return 28;          // CALL nn
+        case 0xC9: return 20;          // RET
+        default: break;
+    }
+    switch (z) {
+        case 0: return 24;             // RET cc
+        case 2: return 20;             // JP cc
+        case 4: return 28;             // CALL cc
+        case 7: return 20;             // RST
+        case 5: return 20;             // PUSH
+        case 1: return 16;             // POP
+        default: return 12;            // ALU A, n
+    }
+}
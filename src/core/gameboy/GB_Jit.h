@@ -0,0 +1,225 @@
+#pragma once
+
+#include "common/types.h"
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+class GB_CPU;
+class GB_MMU;
+
+// Recompilateur x86-64 (option CMake BUILD_GB_JIT) : les blocs chauds du cache
+// de blocs sont traduits en code machine dans un cache exécutable (mmap).
+//
+// Pendant un bloc natif, A, BC, DE, HL et SP vivent dans des registres hôtes
+// (AH, BX, DX, CX, SI : les paires GB tombent sur les octets haut/bas x86).
+// F reste dans le CPU : les flags sont paresseux, le code natif remplit la
+// même structure LazyFlags que l'interpréteur.
+//
+// Les instructions simples (LD, ALU, INC/DEC, PUSH/POP, RES/SET, sauts, appels
+// et retours) sont émises en ligne, avec un chemin rapide par les tables de
+// pages du MMU pour la WRAM (et la HRAM). Tout le reste (I/O, CB, DAA, RETI...)
+// repasse par le handler de l'interpréteur. Avant chaque instruction, le bloc
+// natif vérifie qu'elle se termine avant le prochain événement : sinon elle passe par
+// son handler, qui fait avancer l'horloge, et aucun événement ne tombe dans
+// du code natif.
+//
+// Un saut natif vers un bloc déjà compilé de la même page de code enchaîne
+// directement sur son corps, sans repasser par GB_CPU::runBlock : le budget
+// reste dans r12 et les cycles sont ajoutés à l'horloge en ligne.
+//
+// Le cache de code n'est jamais à la fois inscriptible et exécutable : chaque
+// bloc est écrit, puis ses pages repassent en lecture/exécution (mprotect).
+class GB_Jit {
+public:
+    // Bloc natif : rend les cycles restant à compter (bits 16-30) et
+    // RESULT_STOP s'il s'est arrêté avant la fin
+    using NativeBlock = uint32_t (*)(GB_CPU* cpu);
+    static constexpr uint32_t RESULT_STOP = 0x80000000u;
+
+    // Par octet d'une page de code : corps natif (après le prologue) du bloc
+    // qui y commence, lu par le code natif pour chaîner les blocs
+    using ChainTable = std::array<const uint8_t*, 256>;
+
+    GB_Jit(GB_CPU& cpu, GB_MMU& mmu);
+    ~GB_Jit();
+
+    GB_Jit(const GB_Jit&) = delete;
+    GB_Jit& operator=(const GB_Jit&) = delete;
+
+    // Faux si le cache exécutable n'a pas pu être alloué
+    bool isAvailable() const { return codeBase != nullptr; }
+
+    // Traduit les count instructions du bloc qui commence en start ; chain est
+    // la table de sa page, body reçoit l'entrée pour le chaînage.
+    // Le cache plein est vidé : les blocs d'une époque précédente sont recompilés
+    NativeBlock compile(uint16_t start, uint16_t count, const ChainTable& chain, const uint8_t*& body);
+    uint32_t getEpoch() const { return epoch; }
+
+    // Chemin lent d'une instruction native (page hors table, code modifié...) :
+    // compte les cycles natifs en attente (pending, depuis le dernier appel
+    // hors chemin lent), exécute le handler, rend 1 si le bloc doit s'arrêter.
+    // Les instructions jamais natives appellent directement GB_CPU::jitOp.
+    // op : handlerKey de l'instruction ; counted : cycles de pending déjà
+    // comptés après l'appel ; carry : recopier C dans JitState::carry
+    static uint32_t bailout(GB_CPU* cpu, uint32_t op, uint32_t pending, uint32_t counted, uint32_t carry);
+
+    // Même chose quand le budget de cycles ne couvre pas l'instruction : les
+    // événements échus sont traités, puis le budget est recalculé (elapsed :
+    // borne des cycles écoulés depuis le début du bloc)
+    static uint32_t bailoutChecked(GB_CPU* cpu, uint32_t op, uint32_t pending, uint32_t counted,
+                                   uint32_t elapsed, uint32_t carry);
+
+    static void loadCarry(GB_CPU* cpu);
+
+    // Saut arrière natif : compte les cycles, puis GB_CPU::checkIdleLoop.
+    // Rend 1 si des cycles ont été sautés (le bloc ne peut pas être chaîné)
+    static uint32_t idleLoop(GB_CPU* cpu, uint32_t branch, uint32_t pending);
+
+private:
+    static constexpr size_t CODE_CACHE_SIZE = 16 * 1024 * 1024;
+
+    GB_CPU& cpu;
+    GB_MMU& mmu;
+
+    uint8_t* codeBase = nullptr;
+    size_t codeUsed = 0;
+    uint32_t epoch = 0;
+    size_t pageSize = 4096;
+
+    // Bascule les pages de [begin, begin + size) entre écriture et exécution
+    bool setWritable(uint8_t* begin, size_t size, bool writable);
+
+    // perf (Linux) lit /tmp/perf-<pid>.map pour nommer le code généré
+    FILE* perfMap = nullptr;
+    void writePerfMap(const uint8_t* code, size_t size, uint16_t start);
+
+    // Émission
+    std::vector<uint8_t> buffer;
+
+    struct Fixup {
+        size_t at;      // Position du rel32 à corriger
+        uint32_t label;
+    };
+    std::vector<size_t> labels;
+    std::vector<Fixup> fixups;
+
+    // Chemin lent d'une instruction native : repli sur son handler
+    struct SlowPath {
+        uint32_t label;
+        uint32_t resume;
+        uint32_t op;
+        uint16_t pending;
+        uint8_t cycles;
+        bool writes;
+        bool carry;
+    };
+    std::vector<SlowPath> slowPaths;
+
+    // Budget épuisé avant une instruction : passage par bailoutChecked
+    struct Check {
+        uint32_t label;
+        uint32_t resume;    // Après le code de l'instruction
+        uint32_t op;
+        uint16_t pending;
+        uint16_t counted;   // pending à la reprise
+        uint32_t elapsed;
+        bool carry;
+    };
+    std::vector<Check> checks;
+
+    // Arrêt après un handler (PC déjà à jour)
+    struct Exit {
+        uint32_t label;
+        uint32_t result;
+    };
+    std::vector<Exit> exits;
+
+    // C connu à la compilation, copié dans JitState::carry, ou à calculer
+    // depuis les flags paresseux (après un handler)
+    enum class Carry { Zero, One, Slot, Unknown };
+
+    struct Instruction {
+        uint16_t addr;
+        uint8_t opcode;
+        uint8_t cb;
+        uint8_t imm8;
+        uint16_t imm16;
+    };
+
+    // Décalages dans GB_CPU (adressage [rbp + disp32])
+    int32_t offA, offBC, offDE, offHL, offSP, offPC;
+    int32_t offLazy, offLazyLhs, offLazyRhs, offLazyCarry, offLazyResult;
+    int32_t offBudget, offReadPages, offWritePages, offHRAM, offBailout, offBailoutChecked;
+    int32_t offLoadCarry, offIdleLoop, offCarry, offCounted, offCycles;
+    int32_t offsetOf(const void* field) const;
+
+    void emit8(uint8_t value) { buffer.push_back(value); }
+    void emit16(uint16_t value);
+    void emit32(uint32_t value);
+    void emit64(uint64_t value);
+    void emitDisp(int32_t disp) { emit32(static_cast<uint32_t>(disp)); }
+
+    uint32_t newLabel();
+    void bind(uint32_t label);
+    void jump(uint8_t condition, uint32_t label);  // 0xFF : jmp
+    void resolveFixups();
+
+    void prologue();
+    void epilogue();
+    void spill();
+    void reload();
+
+    // Instruction passée aux bailouts : PC après l'opcode (bits 0-15), opcode
+    // ou 0x100 + opcode CB (bits 16-24). Le code natif ne dépend pas des
+    // micro-ops du cache de blocs, que le décodage d'un autre bloc peut déplacer
+    static uint32_t handlerKey(const Instruction& ins);
+    // Exécute l'instruction op, rend vrai si elle écrit en mémoire
+    static bool runHandler(GB_CPU* cpu, uint32_t op, uint32_t pending, uint32_t counted);
+
+    // État du bloc en cours de compilation
+    Carry carry = Carry::Unknown;
+    bool lazyKnown = false;     // lazy.op != None (Z = résultat nul)
+    uint16_t pending = 0;       // Cycles des instructions natives pas encore comptés
+    uint32_t elapsed = 0;       // Borne haute des cycles depuis l'entrée
+    uint16_t blockStart = 0;
+    const ChainTable* chainTable = nullptr;  // nullptr : pas de chaînage (EI, HALT, STOP)
+    uint32_t exitPC = 0;        // Sortie, PC dans r10
+    uint32_t exitNoPC = 0;      // Sortie, PC déjà à jour
+    uint32_t exitSpilled = 0;   // Sortie, registres déjà recopiés
+
+    void emitBudgetCheck(uint32_t maxElapsed, uint32_t check);
+    uint32_t newStopExit(uint16_t counted);
+    void emitBailout(uint32_t op, uint16_t pending, uint16_t counted, bool carry, uint32_t stop);
+    void emitHandlerCall(const Instruction& ins, uint32_t stop);
+    void emitCheckedBailout(const Check& check);
+    void emitExits();
+
+    bool emitInstruction(const Instruction& ins, uint32_t slow);
+    void emitPagePointer(uint8_t addrReg, bool write, uint32_t slow);
+    void emitConstPagePointer(uint16_t addr, bool write, uint32_t slow);
+    bool emitConstLoadA(uint16_t addr, uint32_t slow);
+    bool emitConstStoreA(uint16_t addr, uint32_t slow);
+    void emitHRAMCodeCheck(uint32_t slow);
+    void emitALU(uint8_t kind, uint8_t src, bool immediate, uint8_t imm);
+    void emitLoadCarry();
+    void emitIncDec(uint8_t reg, bool dec);
+    void emitStackPointer(bool push, uint32_t slow);
+    bool emitPush(uint8_t pair, uint32_t slow);
+    bool emitPop(uint8_t pair, uint32_t slow);
+
+    // Sauts en fin de bloc (cc 0xFF : inconditionnel)
+    uint8_t emitCondition(uint8_t cc, uint32_t slow);
+    template<typename Taken, typename NotTaken>
+    void emitBranch(uint8_t condition, Taken taken, NotTaken notTaken);
+    void emitJumpExit(uint16_t target, uint8_t cycles, bool loop, uint16_t branch);
+    void emitChain(uint16_t target, uint32_t total, uint32_t bound);
+    bool emitJR(const Instruction& ins, uint8_t cc, uint32_t slow);
+    bool emitJP(const Instruction& ins, uint8_t cc, uint32_t slow);
+    bool emitCall(const Instruction& ins, uint8_t cc, uint32_t slow);
+    bool emitRet(const Instruction& ins, uint8_t cc, uint32_t slow);
+
+    static bool isArithmetic(uint8_t opcode);
+    static uint8_t nativeCycles(uint8_t opcode, uint8_t cb);
+};
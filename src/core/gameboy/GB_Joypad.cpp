@@ -1,50 +1,101 @@
 #include "core/gameboy/GB_Joypad.h"
 #include "core/gameboy/GB_MMU.h"
+#include "core/gameboy/GB_Scheduler.h"
+#include "core/gameboy/GB_Interrupts.h"
 #include "utils/Logger.h"
 
-GB_Joypad::GB_Joypad(GB_MMU& mem) : mmu(mem) {
+#include <algorithm>
+
+GB_Joypad::GB_Joypad(GB_MMU& mem, GB_Scheduler& sched, GB_Interrupts& irq)
+    : mmu(mem), scheduler(sched), interrupts(irq) {
+    scheduler.setHandler(GB_Event::Joypad, [this](uint64_t) { onInputEvent(); });
+
+    mmu.mapIO(0xFF00,
+        [](void* ctx, uint16_t) { return static_cast<GB_Joypad*>(ctx)->readP1(); },
+        [](void* ctx, uint16_t, uint8_t data) { static_cast<GB_Joypad*>(ctx)->writeP1(data); },
+        this);
+
     reset();
 }
 
 void GB_Joypad::reset() {
     buttonStates = 0xFF;
+    select = 0x30;
+    pending.clear();
+    scheduler.cancel(GB_Event::Joypad);
+    mmu.directWrite(0xFF00, readP1());
     LOG_DEBUG("GB Joypad reset");
 }
 
+uint8_t GB_Joypad::inputLines() const {
+    uint8_t lines = 0x0F;
+
+    // Boutons : A, B, Select, Start sur les bits 0-3
+    if ((select & 0x20) == 0) lines &= buttonStates & 0x0F;
+    // Croix : Droite, Gauche, Haut, Bas sur les bits 0-3
+    if ((select & 0x10) == 0) lines &= buttonStates >> 4;
+
+    return lines;
+}
+
+uint8_t GB_Joypad::readP1() const {
+    return 0xC0 | select | inputLines();
+}
+
+void GB_Joypad::writeP1(uint8_t value) {
+    // Sélectionner un groupe où un bouton est tenu fait aussi tomber une ligne
+    uint8_t oldLines = inputLines();
+    select = value & 0x30;
+    mmu.directWrite(0xFF00, readP1());
+    updateLines(oldLines);
+}
+
+void GB_Joypad::updateLines(uint8_t oldLines) {
+    if (oldLines & ~inputLines()) {
+        interrupts.request(GB_Interrupts::JOYPAD);
+    }
+}
+
 void GB_Joypad::setButton(int button, bool pressed) {
     if (button < 0 || button > 7) return;
 
+    uint8_t pressedMask = ~buttonStates;
     if (pressed) {
-        buttonStates &= ~(1 << button);
-
-        uint8_t IF = mmu.read(0xFF0F);
-        mmu.write(0xFF0F, IF | 0x10);
+        pressedMask |= (1 << button);
     } else {
-        buttonStates |= (1 << button);
+        pressedMask &= ~(1 << button);
     }
+    setButtons(pressedMask);
 }
 
-void GB_Joypad::update() {
-    uint8_t joyp = mmu.read(0xFF00);
-    uint8_t result = 0xCF;
+void GB_Joypad::setButtons(uint8_t pressedMask) {
+    uint8_t oldLines = inputLines();
+    buttonStates = ~pressedMask;
 
-    if ((joyp & 0x20) == 0) {
-        result &= ~0x20;
+    // Copie en mémoire de fond pour le debugger, les lectures passent par readP1
+    mmu.directWrite(0xFF00, readP1());
+    updateLines(oldLines);
+}
 
-        if ((buttonStates & (1 << Button::A)) == 0)      result &= ~0x01;
-        if ((buttonStates & (1 << Button::B)) == 0)      result &= ~0x02;
-        if ((buttonStates & (1 << Button::SELECT)) == 0) result &= ~0x04;
-        if ((buttonStates & (1 << Button::START)) == 0)  result &= ~0x08;
-    }
+void GB_Joypad::queueButtons(uint8_t pressedMask, uint64_t cycle) {
+    // Les événements de l'hôte arrivent dans l'ordre : un instant antérieur au
+    // dernier en file est ramené à celui-ci
+    if (!pending.empty() && cycle < pending.back().cycle) cycle = pending.back().cycle;
+    pending.push_back({cycle, pressedMask});
 
-    if ((joyp & 0x10) == 0) {
-        result &= ~0x10;
+    if (pending.size() == 1) scheduleNextInput();
+}
 
-        if ((buttonStates & (1 << Button::RIGHT)) == 0) result &= ~0x01;
-        if ((buttonStates & (1 << Button::LEFT)) == 0)  result &= ~0x02;
-        if ((buttonStates & (1 << Button::UP)) == 0)    result &= ~0x04;
-        if ((buttonStates & (1 << Button::DOWN)) == 0)  result &= ~0x08;
+void GB_Joypad::onInputEvent() {
+    uint64_t now = scheduler.now();
+    while (!pending.empty() && pending.front().cycle <= now) {
+        setButtons(pending.front().pressedMask);
+        pending.pop_front();
     }
-    
-    mmu.write(0xFF00, result);
-}
\ No newline at end of file
+    scheduleNextInput();
+}
+
+void GB_Joypad::scheduleNextInput() {
+    if (pending.empty()) return;
+    scheduler.schedule(GB_Event::Joypad, std::max(pending.front().cycle, scheduler.now()));
+}
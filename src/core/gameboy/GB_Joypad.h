@@ -1,15 +1,28 @@
 #pragma once
 #include "common/Types.h"
+#include <deque>
 
 class GB_MMU;
+class GB_Scheduler;
+class GB_Interrupts;
 
+// P1 (0xFF00) calculé à la lecture depuis l'état des boutons et les bits de
+// sélection. Les changements venus de l'hôte peuvent être datés sur l'horloge
+// maître : ils sont appliqués par le scheduler à l'instruction près.
 class GB_Joypad {
 public:
-    GB_Joypad(GB_MMU& mmu);
+    GB_Joypad(GB_MMU& mmu, GB_Scheduler& scheduler, GB_Interrupts& interrupts);
 
     void reset();
-    void update();
+
+    // Changements appliqués immédiatement (masque : bit i = bouton i appuyé)
     void setButton(int button, bool pressed);
+    void setButtons(uint8_t pressedMask);
+    // Masque appliqué au cycle donné (immédiatement s'il est déjà passé)
+    void queueButtons(uint8_t pressedMask, uint64_t cycle);
+
+    uint8_t readP1() const;
+    void writeP1(uint8_t value);
 
     enum Button {
         A      = 0,
@@ -24,5 +37,23 @@ public:
 
 private:
     GB_MMU& mmu;
-    uint8_t buttonStates = 0xFF;
-};
\ No newline at end of file
+    GB_Scheduler& scheduler;
+    GB_Interrupts& interrupts;
+
+    uint8_t buttonStates = 0xFF;  // Bit à 0 = bouton appuyé
+    uint8_t select = 0x30;        // Bits 4-5 de P1 tels qu'écrits (0 = groupe sélectionné)
+
+    struct InputEvent {
+        uint64_t cycle;
+        uint8_t pressedMask;
+    };
+    std::deque<InputEvent> pending;
+
+    // Lignes P10-P13 (bits 0-3, actives à 0) pour les groupes sélectionnés
+    uint8_t inputLines() const;
+    // L'interruption n'est levée que lorsqu'une ligne passe de 1 à 0
+    void updateLines(uint8_t oldLines);
+
+    void onInputEvent();
+    void scheduleNextInput();
+};
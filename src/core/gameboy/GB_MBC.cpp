@@ -0,0 +1,328 @@
+#include "core/gameboy/GB_MBC.h"
+#include "core/gameboy/GB_Scheduler.h"
+#include "utils/Logger.h"
+
+#include <algorithm>
+
+// ============================================================================
+// ROM seule
+// ============================================================================
+
+GB_MBC::GB_MBC(uint16_t romBanks) : romBankCount(std::max<uint16_t>(romBanks, 2)) {
+}
+
+std::unique_ptr<GB_MBC> GB_MBC::create(uint8_t cartridgeType, uint16_t romBankCount,
+                                       const GB_Scheduler& scheduler) {
+    std::unique_ptr<GB_MBC> mbc;
+
+    switch (cartridgeType) {
+        case 0x00: case 0x08: case 0x09:
+            mbc = std::make_unique<GB_MBC>(romBankCount);
+            break;
+        case 0x01: case 0x02: case 0x03:
+            mbc = std::make_unique<GB_MBC1>(romBankCount);
+            break;
+        case 0x05: case 0x06:
+            mbc = std::make_unique<GB_MBC2>(romBankCount);
+            break;
+        case 0x0F: case 0x10: case 0x11: case 0x12: case 0x13:
+            mbc = std::make_unique<GB_MBC3>(romBankCount, scheduler);
+            break;
+        case 0x19: case 0x1A: case 0x1B: case 0x1C: case 0x1D: case 0x1E:
+            mbc = std::make_unique<GB_MBC5>(romBankCount);
+            break;
+        default:
+            LOG_WARN("Unsupported cartridge type {:#04x}, using MBC1", cartridgeType);
+            mbc = std::make_unique<GB_MBC1>(romBankCount);
+            break;
+    }
+
+    mbc->reset();
+    return mbc;
+}
+
+void GB_MBC::reset() {
+    romBank0 = 0;
+    romBankN = wrapROMBank(1);
+    ramBank = 0;
+    ramEnabled = true;
+}
+
+bool GB_MBC::write(uint16_t, uint8_t) {
+    return false;
+}
+
+uint8_t GB_MBC::readRAM(uint16_t addr, const uint8_t* ram, size_t size) const {
+    if (!ramEnabled || size == 0) return 0xFF;
+    return ram[ramOffset(addr, size)];
+}
+
+uint32_t GB_MBC::writeRAM(uint16_t addr, uint8_t data, uint8_t* ram, size_t size) {
+    if (!ramEnabled || size == 0) return NO_RAM;
+
+    uint32_t offset = ramOffset(addr, size);
+    ram[offset] = data;
+    return offset;
+}
+
+// ============================================================================
+// MBC1
+// ============================================================================
+
+void GB_MBC1::reset() {
+    GB_MBC::reset();
+    ramEnabled = false;
+    bank1 = 1;
+    bank2 = 0;
+    advancedMode = false;
+    updateBanks();
+}
+
+bool GB_MBC1::write(uint16_t addr, uint8_t data) {
+    // RAM Enable (0x0000-0x1FFF)
+    if (addr < 0x2000) {
+        ramEnabled = (data & 0x0F) == 0x0A;
+        return true;
+    }
+
+    if (addr < 0x4000) {
+        bank1 = data & 0x1F;         // 5 bits
+        if (bank1 == 0) bank1 = 1;   // Bank 0 pas accessible ici
+    } else if (addr < 0x6000) {
+        bank2 = data & 0x03;         // Bits 5-6 de la banque ROM ou banque RAM
+    } else {
+        advancedMode = (data & 0x01) != 0;
+    }
+
+    updateBanks();
+    return true;
+}
+
+void GB_MBC1::updateBanks() {
+    romBankN = wrapROMBank((bank2 << 5) | bank1);
+
+    // Mode 1 : bank2 s'applique aussi à 0x0000-0x3FFF et à la RAM
+    romBank0 = advancedMode ? wrapROMBank(bank2 << 5) : 0;
+    ramBank = advancedMode ? bank2 : 0;
+}
+
+// ============================================================================
+// MBC2
+// ============================================================================
+
+void GB_MBC2::reset() {
+    GB_MBC::reset();
+    ramEnabled = false;
+}
+
+bool GB_MBC2::write(uint16_t addr, uint8_t data) {
+    if (addr >= 0x4000) return false;
+
+    // Le bit 8 de l'adresse choisit entre RAM Enable et numéro de banque
+    if (addr & 0x0100) {
+        uint8_t bank = data & 0x0F;
+        if (bank == 0) bank = 1;
+        romBankN = wrapROMBank(bank);
+        return true;
+    }
+
+    ramEnabled = (data & 0x0F) == 0x0A;
+    return true;
+}
+
+uint8_t GB_MBC2::readRAM(uint16_t addr, const uint8_t* ram, size_t size) const {
+    // 512 demi-octets répétés sur toute la plage, bits hauts à 1
+    uint16_t offset = addr & 0x01FF;
+    if (!ramEnabled || offset >= size) return 0xFF;
+    return ram[offset] | 0xF0;
+}
+
+uint32_t GB_MBC2::writeRAM(uint16_t addr, uint8_t data, uint8_t* ram, size_t size) {
+    uint16_t offset = addr & 0x01FF;
+    if (!ramEnabled || offset >= size) return NO_RAM;
+
+    ram[offset] = data & 0x0F;
+    return offset;
+}
+
+// ============================================================================
+// MBC3
+// ============================================================================
+
+GB_MBC3::GB_MBC3(uint16_t romBanks, const GB_Scheduler& sched)
+    : GB_MBC(romBanks), scheduler(sched), rtcSyncTime(sched.now()) {
+}
+
+void GB_MBC3::prepareReset() {
+    // L'horloge continue de tourner : le temps écoulé depuis la dernière
+    // synchro est acquis avant que l'horloge maître reparte de zéro
+    syncRTC();
+}
+
+void GB_MBC3::reset() {
+    GB_MBC::reset();
+    ramEnabled = false;
+    rtcSelect = 0;
+    latchWrite = 0xFF;
+
+    // Temps déjà acquis par prepareReset : seul le point de synchro suit l'horloge maître
+    rtcSyncTime = scheduler.now();
+}
+
+bool GB_MBC3::write(uint16_t addr, uint8_t data) {
+    // RAM / RTC Enable (0x0000-0x1FFF)
+    if (addr < 0x2000) {
+        ramEnabled = (data & 0x0F) == 0x0A;
+        return true;
+    }
+
+    // ROM Bank Number (0x2000-0x3FFF)
+    if (addr < 0x4000) {
+        uint8_t bank = data & 0x7F;  // 7 bits
+        if (bank == 0) bank = 1;
+        romBankN = wrapROMBank(bank);
+        return true;
+    }
+
+    // RAM Bank Number ou registre RTC (0x4000-0x5FFF)
+    if (addr < 0x6000) {
+        if (data <= 0x03) {
+            ramBank = data;
+            rtcSelect = 0;
+        } else if (data >= 0x08 && data <= 0x0C) {
+            rtcSelect = data;
+        }
+        return true;
+    }
+
+    // Latch Clock Data (0x6000-0x7FFF) : écriture de 0 puis 1
+    if (latchWrite == 0x00 && data == 0x01) {
+        latchRTC();
+    }
+    latchWrite = data;
+    return false;
+}
+
+uint8_t GB_MBC3::readRAM(uint16_t addr, const uint8_t* ram, size_t size) const {
+    if (!ramEnabled) return 0xFF;
+    if (rtcSelect) return latched[rtcSelect - 0x08];
+    return GB_MBC::readRAM(addr, ram, size);
+}
+
+uint32_t GB_MBC3::writeRAM(uint16_t addr, uint8_t data, uint8_t* ram, size_t size) {
+    if (!ramEnabled) return NO_RAM;
+    if (rtcSelect) {
+        writeRTC(rtcSelect, data);
+        return NO_RAM;
+    }
+    return GB_MBC::writeRAM(addr, data, ram, size);
+}
+
+uint64_t GB_MBC3::currentCycles() const {
+    uint64_t now = scheduler.now();
+    if (rtcHalted) return rtcCycles;
+    if (now < rtcSyncTime) {
+        // Horloge maître remise à zéro sans prepareReset : le temps écoulé est perdu
+        LOG_ERROR("MBC3 RTC: master clock went back ({} < {})", now, rtcSyncTime);
+        return rtcCycles;
+    }
+    return rtcCycles + (now - rtcSyncTime);
+}
+
+void GB_MBC3::syncRTC() {
+    constexpr uint64_t WRAP = 512 * SECONDS_PER_DAY * CYCLES_PER_SECOND;
+
+    rtcCycles = currentCycles();
+    rtcSyncTime = scheduler.now();
+
+    // Compteur de jours sur 9 bits : le débordement reste signalé jusqu'à
+    // ce que le jeu efface le bit
+    if (rtcCycles >= WRAP) {
+        rtcCycles %= WRAP;
+        dayCarry = true;
+    }
+}
+
+void GB_MBC3::latchRTC() {
+    syncRTC();
+    for (uint8_t reg = 0x08; reg <= 0x0C; ++reg) {
+        latched[reg - 0x08] = rtcRegister(rtcCycles, reg);
+    }
+}
+
+uint8_t GB_MBC3::rtcRegister(uint64_t cycles, uint8_t reg) const {
+    uint64_t seconds = cycles / CYCLES_PER_SECOND;
+    uint64_t days = seconds / SECONDS_PER_DAY;
+
+    switch (reg) {
+        case 0x08: return seconds % 60;
+        case 0x09: return (seconds / 60) % 60;
+        case 0x0A: return (seconds / 3600) % 24;
+        case 0x0B: return days & 0xFF;
+        case 0x0C: return ((days >> 8) & 0x01) | (rtcHalted ? 0x40 : 0) | (dayCarry ? 0x80 : 0);
+    }
+    return 0xFF;
+}
+
+void GB_MBC3::writeRTC(uint8_t reg, uint8_t data) {
+    syncRTC();
+
+    uint64_t seconds = rtcCycles / CYCLES_PER_SECOND;
+    uint64_t subSecond = rtcCycles % CYCLES_PER_SECOND;
+
+    uint64_t s = seconds % 60;
+    uint64_t m = (seconds / 60) % 60;
+    uint64_t h = (seconds / 3600) % 24;
+    uint64_t d = seconds / SECONDS_PER_DAY;
+
+    switch (reg) {
+        case 0x08: s = data & 0x3F; subSecond = 0; break;  // Écrire les secondes remet le diviseur à 0
+        case 0x09: m = data & 0x3F; break;
+        case 0x0A: h = data & 0x1F; break;
+        case 0x0B: d = (d & 0x100) | data; break;
+        case 0x0C:
+            d = (d & 0xFF) | ((data & 0x01) << 8);
+            rtcHalted = (data & 0x40) != 0;
+            dayCarry = (data & 0x80) != 0;
+            break;
+    }
+
+    rtcCycles = (((d * 24 + h) * 60 + m) * 60 + s) * CYCLES_PER_SECOND + subSecond;
+    latched[reg - 0x08] = rtcRegister(rtcCycles, reg);
+}
+
+// ============================================================================
+// MBC5
+// ============================================================================
+
+void GB_MBC5::reset() {
+    GB_MBC::reset();
+    ramEnabled = false;
+    bank = 1;
+}
+
+bool GB_MBC5::write(uint16_t addr, uint8_t data) {
+    // RAM Enable (0x0000-0x1FFF)
+    if (addr < 0x2000) {
+        ramEnabled = (data & 0x0F) == 0x0A;
+        return true;
+    }
+
+    // ROM Bank Number : 8 bits bas (0x2000-0x2FFF), bit 8 (0x3000-0x3FFF)
+    if (addr < 0x4000) {
+        if (addr < 0x3000) {
+            bank = (bank & 0x100) | data;
+        } else {
+            bank = (bank & 0xFF) | ((data & 0x01) << 8);
+        }
+        romBankN = wrapROMBank(bank);  // La banque 0 est accessible en 0x4000
+        return true;
+    }
+
+    // RAM Bank Number (0x4000-0x5FFF)
+    if (addr < 0x6000) {
+        ramBank = data & 0x0F;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include "common/types.h"
+#include <memory>
+#include <cstddef>
+
+class GB_Scheduler;
+
+// Contrôleur de banques de la cartouche (type en 0x0147).
+// Le MBC ne fait que tenir l'état des registres : le MMU lit les numéros de
+// banque après chaque écriture qui change le mapping et repointe ses pages.
+// La classe de base correspond à une cartouche sans MBC (ROM seule, RAM optionnelle).
+class GB_MBC {
+public:
+    explicit GB_MBC(uint16_t romBankCount);
+    virtual ~GB_MBC() = default;
+
+    static std::unique_ptr<GB_MBC> create(uint8_t cartridgeType, uint16_t romBankCount,
+                                          const GB_Scheduler& scheduler);
+
+    // Appelé avant la remise à zéro de l'horloge maître, tant que
+    // scheduler.now() est encore celui de l'ancienne session
+    virtual void prepareReset() {}
+    virtual void reset();
+    virtual const char* getName() const { return "ROM only"; }
+
+    // Écriture dans 0x0000-0x7FFF, renvoie true si le mapping (banques ROM,
+    // banque ou activation de la RAM) a changé
+    virtual bool write(uint16_t addr, uint8_t data);
+
+    // RAM externe (0xA000-0xBFFF), allouée une fois par le MMU
+    static constexpr uint32_t NO_RAM = ~0u;
+    virtual uint8_t readRAM(uint16_t addr, const uint8_t* ram, size_t size) const;
+    // Renvoie l'offset écrit dans la RAM, NO_RAM si l'écriture n'y a pas abouti
+    virtual uint32_t writeRAM(uint16_t addr, uint8_t data, uint8_t* ram, size_t size);
+
+    uint16_t getROMBank0() const { return romBank0; }  // Banque vue en 0x0000-0x3FFF
+    uint16_t getROMBankN() const { return romBankN; }  // Banque vue en 0x4000-0x7FFF
+
+    // true si 0xA000-0xBFFF montre la RAM telle quelle (le MMU peut alors y lire directement)
+    virtual bool isRAMMapped() const { return ramEnabled; }
+    uint32_t getRAMBankBase() const { return ramBank * 0x2000u; }
+
+protected:
+    uint16_t romBankCount;
+
+    uint16_t romBank0 = 0;
+    uint16_t romBankN = 1;
+    uint8_t ramBank = 0;
+    bool ramEnabled = true;
+
+    uint16_t wrapROMBank(uint32_t bank) const { return static_cast<uint16_t>(bank % romBankCount); }
+    // Les petites RAM (2 KB) et les numéros de banque trop grands bouclent
+    uint32_t ramOffset(uint16_t addr, size_t size) const {
+        return static_cast<uint32_t>((getRAMBankBase() + (addr - 0xA000)) % size);
+    }
+};
+
+// MBC1 : banque ROM sur 5 bits + 2 bits partagés ROM/RAM selon le mode
+class GB_MBC1 : public GB_MBC {
+public:
+    using GB_MBC::GB_MBC;
+
+    void reset() override;
+    const char* getName() const override { return "MBC1"; }
+    bool write(uint16_t addr, uint8_t data) override;
+
+private:
+    uint8_t bank1 = 1;      // 0x2000-0x3FFF
+    uint8_t bank2 = 0;      // 0x4000-0x5FFF
+    bool advancedMode = false;
+
+    void updateBanks();
+};
+
+// MBC2 : 16 banques ROM, 512 x 4 bits de RAM intégrée
+class GB_MBC2 : public GB_MBC {
+public:
+    using GB_MBC::GB_MBC;
+
+    void reset() override;
+    const char* getName() const override { return "MBC2"; }
+    bool write(uint16_t addr, uint8_t data) override;
+
+    uint8_t readRAM(uint16_t addr, const uint8_t* ram, size_t size) const override;
+    uint32_t writeRAM(uint16_t addr, uint8_t data, uint8_t* ram, size_t size) override;
+
+    bool isRAMMapped() const override { return false; }  // Demi-octets
+};
+
+// MBC3 : banque ROM sur 7 bits, 4 banques RAM et horloge temps réel.
+// L'horloge n'est jamais incrémentée : elle est recalculée à la lecture à
+// partir du temps émulé écoulé depuis la dernière synchro.
+class GB_MBC3 : public GB_MBC {
+public:
+    GB_MBC3(uint16_t romBankCount, const GB_Scheduler& scheduler);
+
+    void prepareReset() override;
+    void reset() override;
+    const char* getName() const override { return "MBC3"; }
+    bool write(uint16_t addr, uint8_t data) override;
+
+    uint8_t readRAM(uint16_t addr, const uint8_t* ram, size_t size) const override;
+    uint32_t writeRAM(uint16_t addr, uint8_t data, uint8_t* ram, size_t size) override;
+
+    bool isRAMMapped() const override { return ramEnabled && rtcSelect == 0; }
+
+private:
+    static constexpr uint64_t CYCLES_PER_SECOND = 4194304;
+    static constexpr uint64_t SECONDS_PER_DAY = 86400;
+
+    const GB_Scheduler& scheduler;
+
+    uint8_t rtcSelect = 0;       // 0x08-0x0C : registre RTC mappé en 0xA000, 0 = RAM
+    uint8_t latchWrite = 0xFF;
+
+    // Temps de l'horloge en cycles, valable à rtcSyncTime
+    uint64_t rtcCycles = 0;
+    uint64_t rtcSyncTime = 0;
+    bool rtcHalted = false;
+    bool dayCarry = false;
+
+    // S, M, H, DL, DH figés par le dernier latch
+    uint8_t latched[5] = {};
+
+    uint64_t currentCycles() const;
+    void syncRTC();
+    void latchRTC();
+    uint8_t rtcRegister(uint64_t cycles, uint8_t reg) const;
+    void writeRTC(uint8_t reg, uint8_t data);
+};
+
+// MBC5 : banque ROM sur 9 bits (banque 0 autorisée), 16 banques RAM
+class GB_MBC5 : public GB_MBC {
+public:
+    using GB_MBC::GB_MBC;
+
+    void reset() override;
+    const char* getName() const override { return "MBC5"; }
+    bool write(uint16_t addr, uint8_t data) override;
+
+private:
+    uint16_t bank = 1;
+};
@@ -1,48 +1,106 @@
 #include "core/gameboy/GB_MMU.h"
+#include "core/gameboy/GB_Scheduler.h"
+#include "core/gameboy/GB_Interrupts.h"
 #include "utils/Logger.h"
 #include "utils/FileUtils.h"
 
-GB_MMU::GB_MMU() {
+#include <filesystem>
+
+GB_MMU::GB_MMU(GB_Scheduler& sched, GB_Interrupts& irq) : scheduler(sched), interrupts(irq) {
     reset();
+
+    // Boot ROM disable
+    mapIO(0xFF50,
+        [](void* ctx, uint16_t) -> uint8_t {
+            return static_cast<GB_MMU*>(ctx)->boot_rom_enabled ? 0x00 : 0x01;
+        },
+        [](void* ctx, uint16_t, uint8_t data) {
+            auto* self = static_cast<GB_MMU*>(ctx);
+            if (data != 0 && self->boot_rom_enabled) {
+                self->boot_rom_enabled = false;
+                self->rebuildPageTables();
+                LOG_INFO("Boot ROM disabled");
+            }
+        },
+        this);
+
+    // IF : tenu par le contrôleur d'interruptions
+    mapIO(0xFF0F,
+        [](void* ctx, uint16_t) { return static_cast<GB_MMU*>(ctx)->interrupts.readIF(); },
+        [](void* ctx, uint16_t, uint8_t data) { static_cast<GB_MMU*>(ctx)->interrupts.writeIF(data); },
+        this);
+
+    // OAM DMA : la valeur écrite reste lisible dans la mémoire de fond
+    mapIO(0xFF46, nullptr,
+        [](void* ctx, uint16_t addr, uint8_t data) {
+            auto* self = static_cast<GB_MMU*>(ctx);
+            self->directWrite(addr, data);
+            self->startDMA(data);
+        },
+        this);
+
+    scheduler.setHandler(GB_Event::DMA, [this](uint64_t) { endDMA(); });
+}
+
+void GB_MMU::mapIO(uint16_t addr, IOReadHandler read, IOWriteHandler write, void* ctx) {
+    if (addr < 0xFF00 || addr >= 0xFF80) {
+        LOG_ERROR("mapIO: {:#06x} is not an I/O register", addr);
+        return;
+    }
+    ioHandlers[addr & 0x7F] = {read, write, ctx};
 }
 
 void GB_MMU::reset() {
     memory.fill(0);
-    external_RAM.clear();
+    tileDirty.fill(~0ULL);
+    codePages.fill(0);
+    saveFile.close();
+    external_RAM_buffer.clear();
+    external_RAM = nullptr;
+    external_RAM_size = 0;
+    ramDirtyPages.clear();
     //rom_data.clear();
-    boot_rom.clear();
+    boot_rom.reset();
 
-    current_ROM_bank = 1;
-    current_RAM_bank = 0;
     boot_rom_enabled = false;  // Pas de Boot ROM par défaut
+    dma_active = false;
+    video_trap = false;
+    mbc = GB_MBC::create(0x00, 2, scheduler);
+
+    rebuildPageTables();
 
     LOG_DEBUG("GB MMU reset");
 }
 
 bool GB_MMU::loadBootROM(const std::string& path) {
-    boot_rom = FileUtils::readBinaryFile(path);
+    boot_rom = FileUtils::openRomImage(path);
 
-    if (boot_rom.empty() || boot_rom.size() != 256) {
+    if (!boot_rom || boot_rom->size() != 256) {
         LOG_WARN("Boot ROM invalid or missing: {}", path);
-        boot_rom.clear();
+        boot_rom.reset();
         return false;
     }
 
     boot_rom_enabled = true;
+    rebuildPageTables();
     LOG_INFO("Boot ROM loaded: {}", path);
     return true;
 }
 
 bool GB_MMU::loadROM(const std::string& path) {
-    rom_data = FileUtils::readBinaryFile(path);
+    FileUtils::RomImagePtr image = FileUtils::openRomImage(path);
 
-    if (rom_data.empty()) {
+    if (!image || image->empty()) {
         LOG_ERROR("Failed to load ROM: {}", path);
         return false;
     }
 
+    rom_image = std::move(image);
+    rom_data = rom_image->data();
+    rom_size = rom_image->size();
+
     // Affiche les infos de la ROM
-    if (rom_data.size() >= 0x0150) {
+    if (rom_size >= 0x0150) {
         // Titre de la ROM (0x0134-0x0143)
         std::string title;
         for (int i = 0x0134; i < 0x0143 && rom_data[i] != 0; ++i) {
@@ -58,60 +116,232 @@ bool GB_MMU::loadROM(const std::string& path) {
         LOG_INFO("  Type: {:#04x}", cartridge_type);
         LOG_INFO("  ROM size: {:#04x}", rom_size_code);
         LOG_INFO("  RAM size: {:#04x}", ram_size_code);
-        LOG_INFO("  Total size: {} bytes", rom_data.size());
+        LOG_INFO("  Total size: {} bytes", rom_size);
     } else {
-        LOG_INFO("ROM loaded: {} ({} bytes)", path, rom_data.size());
+        LOG_INFO("ROM loaded: {} ({} bytes)", path, rom_size);
     }
 
+    uint8_t cartridge_type = rom_size > 0x0147 ? rom_data[0x0147] : 0x00;
+    uint8_t ram_size_code = rom_size > 0x0149 ? rom_data[0x0149] : 0x00;
+    uint16_t rom_banks = static_cast<uint16_t>((rom_size + 0x3FFF) / 0x4000);
+    mbc = GB_MBC::create(cartridge_type, rom_banks, scheduler);
+    allocateExternalRAM(path, cartridge_type, ram_size_code);
+    LOG_INFO("  Mapper: {} ({} bytes RAM)", mbc->getName(), external_RAM_size);
+
+    rebuildPageTables();
+
     return true;
 }
 
-uint8_t GB_MMU::read(uint16_t addr) const {
-    // Boot ROM (0x0000-0x00FF)
-    if (boot_rom_enabled && addr < 0x0100 && !boot_rom.empty()) {
-        return boot_rom[addr];
+static bool hasBattery(uint8_t cartridgeType) {
+    switch (cartridgeType) {
+        case 0x03: case 0x06: case 0x09: case 0x0F: case 0x10: case 0x13: case 0x1B: case 0x1E:
+            return true;
+        default:
+            return false;
     }
+}
 
-    // ROM Bank 0 (0x0000-0x3FFF)
-    if (addr < 0x4000) {
-        if (addr < rom_data.size()) {
-            return rom_data[addr];
+void GB_MMU::allocateExternalRAM(const std::string& romPath, uint8_t cartridgeType, uint8_t ramSizeCode) {
+    size_t size = 0;
+
+    if (cartridgeType == 0x05 || cartridgeType == 0x06) {
+        size = 512;  // MBC2 : RAM intégrée, l'en-tête indique 0
+    } else {
+        switch (ramSizeCode) {
+            case 0x01: size = 0x800;   break;  // 2 KB
+            case 0x02: size = 0x2000;  break;  // 8 KB
+            case 0x03: size = 0x8000;  break;  // 32 KB (4 banques)
+            case 0x04: size = 0x20000; break;  // 128 KB (16 banques)
+            case 0x05: size = 0x10000; break;  // 64 KB (8 banques)
+            default: break;
         }
-        return 0xFF;
     }
 
-    // ROM Bank 1-N (0x4000-0x7FFF) - Switchable
-    if (addr >= 0x4000 && addr < 0x8000) {
-        uint32_t rom_addr = (current_ROM_bank * 0x4000) + (addr - 0x4000);
-        if (rom_addr < rom_data.size()) {
-            return rom_data[rom_addr];
+    saveFile.close();
+    external_RAM_buffer.clear();
+    external_RAM = nullptr;
+
+    // Cartouche à pile : la RAM est le fichier .sav à côté de la ROM
+    if (size > 0 && hasBattery(cartridgeType)) {
+        std::string savePath = std::filesystem::path(romPath).replace_extension(".sav").string();
+        if (saveFile.open(savePath, size)) {
+            external_RAM = saveFile.data();
+        } else {
+            LOG_WARN("Battery save disabled, RAM will not persist");
         }
-        return 0xFF;
     }
 
-    // VRAM (0x8000-0x9FFF)
-    if (addr >= 0x8000 && addr < 0xA000) {
-        return memory[addr];
+    if (!external_RAM) {
+        external_RAM_buffer.assign(size, 0);
+        external_RAM = external_RAM_buffer.data();
     }
+    external_RAM_size = size;
+    ramDirtyPages.assign((size / RAM_PAGE_SIZE + 63) / 64, 0);
+}
 
-    // External RAM (0xA000-0xBFFF) - Switchable
-    if (addr >= 0xA000 && addr < 0xC000) {
-        uint16_t ram_addr = (current_RAM_bank * 0x2000) + (addr - 0xA000);
-        if (ram_addr < external_RAM.size()) {
-            return external_RAM[ram_addr];
+void GB_MMU::rebuildPageTables() {
+    readPages.fill(nullptr);
+    writePages.fill(nullptr);
+    codeGeneration++;
+
+    // Pendant une DMA tout passe par le chemin lent, qui bloque le bus
+    if (dma_active) return;
+
+    mapROMPages();
+    mapRAMPages();
+
+    // VRAM (0x8000-0x9FFF) et Work RAM (0xC000-0xDFFF). Les tuiles
+    // (0x8000-0x97FF) s'écrivent par le chemin lent pour invalider le cache,
+    // les tile maps aussi tant que le piège vidéo est armé
+    for (uint32_t page = 0x80; page < 0xA0; ++page) {
+        readPages[page] = memory.data() + (page << 8);
+        writePages[page] = (page >= 0x98 && !video_trap) ? memory.data() + (page << 8) : nullptr;
+    }
+    for (uint32_t page = 0xC0; page < 0xE0; ++page) {
+        readPages[page] = memory.data() + (page << 8);
+        writePages[page] = isCodePage(page) ? nullptr : memory.data() + (page << 8);
+    }
+
+    // Echo RAM (0xE000-0xFDFF) - Mirror de WRAM
+    for (uint32_t page = 0xE0; page < 0xFE; ++page) {
+        readPages[page] = memory.data() + ((page - 0x20) << 8);
+        writePages[page] = isCodePage(page - 0x20) ? nullptr : memory.data() + ((page - 0x20) << 8);
+    }
+}
+
+void GB_MMU::protectCodePage(uint8_t page) {
+    codePages[page >> 6] |= 1ULL << (page & 63);
+
+    // WRAM : la page et son miroir dans l'echo passent sur le chemin lent
+    // (la HRAM y est déjà)
+    if (page >= 0xC0 && page < 0xE0) {
+        writePages[page] = nullptr;
+        if (page + 0x20 < 0xFE) writePages[page + 0x20] = nullptr;
+    }
+}
+
+void GB_MMU::releaseCodePage(uint8_t page) {
+    codePages[page >> 6] &= ~(1ULL << (page & 63));
+    codeGeneration++;
+
+    if (page >= 0xC0 && page < 0xE0 && !dma_active) {
+        writePages[page] = memory.data() + (page << 8);
+        if (page + 0x20 < 0xFE) writePages[page + 0x20] = memory.data() + (page << 8);
+    }
+
+    if (codeWriteHandler) {
+        uint32_t id = romCodePages() + (page == 0xFF ? WRAM_CODE_PAGES : page - 0xC0u);
+        codeWriteHandler(codeWriteCtx, id);
+    }
+}
+
+void GB_MMU::resetMapper() {
+    mbc->reset();
+    codePages.fill(0);
+    dma_active = false;
+    scheduler.cancel(GB_Event::DMA);
+    rebuildPageTables();
+}
+
+void GB_MMU::setVideoWriteTrap(bool enabled) {
+    if (enabled == video_trap) return;
+    video_trap = enabled;
+
+    if (dma_active) return;  // Les pages seront reconstruites en fin de DMA
+    for (uint32_t page = 0x98; page < 0xA0; ++page) {
+        writePages[page] = enabled ? nullptr : memory.data() + (page << 8);
+    }
+}
+
+void GB_MMU::startDMA(uint8_t source) {
+
+    // 0xE000-0xFFFF n'existe pas côté DMA : la source retombe dans la WRAM
+    uint8_t sourcePage = source >= 0xE0 ? source - 0x20 : source;
+    uint16_t base = sourcePage << 8;
+
+    // Copie en un bloc, faite avant de verrouiller le bus (160 octets : une seule page)
+    uint8_t* oam = memory.data() + 0xFE00;
+    const uint8_t* page = readPages[sourcePage];  // nullptr si la DMA redémarre
+    if (page) {
+        std::copy(page, page + 0xA0, oam);
+    } else {
+        bool locked = dma_active;
+        dma_active = false;
+        for (uint16_t i = 0; i < 0xA0; ++i) {
+            oam[i] = readSlow(base + i);
         }
-        return 0xFF;
+        dma_active = locked;
     }
 
-    // Work RAM Bank 0 (0xC000-0xCFFF)
-    // Work RAM Bank 1 (0xD000-0xDFFF)
-    if (addr >= 0xC000 && addr < 0xE000) {
+    // Fenêtre de blocage : une seule échéance, relancée si la DMA redémarre
+    if (!dma_active) {
+        dma_active = true;
+        rebuildPageTables();
+    }
+    scheduler.scheduleIn(GB_Event::DMA, DMA_CYCLES);
+}
+
+void GB_MMU::endDMA() {
+    dma_active = false;
+    rebuildPageTables();
+}
+
+void GB_MMU::mapRAMPages() {
+    // External RAM (0xA000-0xBFFF) : lecture directe quand le MBC montre la RAM
+    // telle quelle. Les écritures restent sur le chemin lent (bitmap des pages sales).
+    bool mapped = mbc->isRAMMapped() && external_RAM_size > 0;
+    uint32_t base = mbc->getRAMBankBase();
+    for (uint32_t page = 0xA0; page < 0xC0; ++page) {
+        uint32_t offset = (base + ((page - 0xA0) << 8)) % std::max<size_t>(external_RAM_size, 1);
+        readPages[page] = mapped ? external_RAM + offset : nullptr;
+    }
+}
+
+void GB_MMU::mapROMPages() {
+    // ROM Bank 0 (0x0000-0x3FFF) et Bank 1-N (0x4000-0x7FFF), choisies par le MBC.
+    // Les pages qui dépassent la fin de l'image restent sur le chemin lent.
+    const uint32_t bases[2] = { mbc->getROMBank0() * 0x4000u, mbc->getROMBankN() * 0x4000u };
+    for (uint32_t page = 0x00; page < 0x80; ++page) {
+        uint32_t offset = bases[page >> 6] + ((page & 0x3F) << 8);
+        readPages[page] = (offset + 0x100 <= rom_size) ? rom_data + offset : nullptr;
+    }
+
+    // La Boot ROM recouvre la première page
+    if (boot_rom_enabled && boot_rom) {
+        readPages[0x00] = boot_rom->data();
+    }
+}
+
+uint8_t GB_MMU::readSlow(uint16_t addr) const {
+    // HRAM (0xFF80-0xFFFE) : le cas le plus fréquent ici (variables en LDH)
+    if (addr >= 0xFF80 && addr < 0xFFFF) {
         return memory[addr];
     }
 
-    // Echo RAM (0xE000-0xFDFF) - Mirror de WRAM
-    if (addr >= 0xE000 && addr < 0xFE00) {
-        return memory[addr - 0x2000];
+    // OAM DMA en cours : seuls les registres I/O, la HRAM et IE répondent
+    if (dma_active && addr < 0xFF00) {
+        return 0xFF;
+    }
+
+    // Boot ROM (0x0000-0x00FF)
+    if (boot_rom_enabled && addr < 0x0100 && boot_rom) {
+        return (*boot_rom)[addr];
+    }
+
+    // ROM Bank 0 (0x0000-0x3FFF) / Bank 1-N (0x4000-0x7FFF) hors de l'image
+    if (addr < 0x8000) {
+        uint16_t bank = (addr < 0x4000) ? mbc->getROMBank0() : mbc->getROMBankN();
+        uint32_t rom_addr = bank * 0x4000u + (addr & 0x3FFF);
+        if (rom_addr < rom_size) {
+            return rom_data[rom_addr];
+        }
+        return 0xFF;
+    }
+
+    // External RAM (0xA000-0xBFFF) - Switchable
+    if (addr >= 0xA000 && addr < 0xC000) {
+        return mbc->readRAM(addr, external_RAM, external_RAM_size);
     }
 
     // OAM (0xFE00-0xFE9F)
@@ -126,118 +356,95 @@ uint8_t GB_MMU::read(uint16_t addr) const {
 
     // I/O Registers (0xFF00-0xFF7F)
     if (addr >= 0xFF00 && addr < 0xFF80) {
-
-        if (addr == 0xFF04 && timer) {
-            return timer->getDIV();
-        }
-
-        // Registre spécial: Boot ROM disable
-        if (addr == 0xFF50) {
-            return boot_rom_enabled ? 0x00 : 0x01;
-        }
-        return memory[addr];
-    }
-
-    // HRAM (0xFF80-0xFFFE)
-    if (addr >= 0xFF80 && addr < 0xFFFF) {
-        return memory[addr];
+        const IOHandler& io = ioHandlers[addr & 0x7F];
+        return io.read ? io.read(io.ctx, addr) : memory[addr];
     }
 
     // IE Register (0xFFFF)
     if (addr == 0xFFFF) {
-        return memory[addr];
+        return interrupts.readIE();
     }
 
     return 0xFF;
 }
 
-void GB_MMU::write(uint16_t addr, uint8_t data) {
-    // ROM (0x0000-0x7FFF) - MBC control
-    if (addr < 0x8000) {
-        handleMBCWrite(addr, data);
-        return;
-    }
-
-    // VRAM (0x8000-0x9FFF)
-    if (addr >= 0x8000 && addr < 0xA000) {
-        static int vramWriteCount = 0;
-        if (vramWriteCount++ < 20) {
-            LOG_DEBUG("VRAM write: [{:#06x}] = {:#04x}", addr, data);
-        }
+void GB_MMU::writeSlow(uint16_t addr, uint8_t data) {
+    // HRAM (0xFF80-0xFFFE)
+    if (addr >= 0xFF80 && addr < 0xFFFF) {
+        if (isCodePage(0xFF)) releaseCodePage(0xFF);
         memory[addr] = data;
         return;
     }
 
-    // External RAM (0xA000-0xBFFF)
-    if (addr >= 0xA000 && addr < 0xC000) {
-        uint16_t ram_addr = (current_RAM_bank * 0x2000) + (addr - 0xA000);
-        if (ram_addr >= external_RAM.size()) {
-            external_RAM.resize(ram_addr + 1, 0);
-        }
-        external_RAM[ram_addr] = data;
+    if (dma_active && addr < 0xFF00) {
         return;
     }
 
-    // Work RAM (0xC000-0xDFFF)
-    if (addr >= 0xC000 && addr < 0xE000) {
-        memory[addr] = data;
+    // WRAM et echo (0xC000-0xFDFF) : seulement les pages qui contiennent du code en cache
+    if (addr >= 0xC000 && addr < 0xFE00) {
+        uint16_t wramAddr = (addr >= 0xE000) ? addr - 0x2000 : addr;
+        if (isCodePage(wramAddr >> 8)) releaseCodePage(wramAddr >> 8);
+        memory[wramAddr] = data;
         return;
     }
 
-    // Echo RAM (0xE000-0xFDFF)
-    if (addr >= 0xE000 && addr < 0xFE00) {
-        memory[addr - 0x2000] = data;
+    // ROM (0x0000-0x7FFF) - MBC control
+    if (addr < 0x8000) {
+        handleMBCWrite(addr, data);
         return;
     }
 
-    // OAM (0xFE00-0xFE9F)
-    if (addr >= 0xFE00 && addr < 0xFEA0) {
-        memory[addr] = data;
+    // VRAM, données des tuiles (0x8000-0x97FF)
+    if (addr < 0x9800) {
+        if (memory[addr] != data) {
+            beforeVideoWrite();
+            memory[addr] = data;
+            size_t tile = (addr - 0x8000) >> 4;
+            tileDirty[tile >> 6] |= 1ULL << (tile & 63);
+        }
         return;
     }
 
-    if (addr == 0xFF04) {
-        if (timer) {
-            timer->resetDIV();
+    // VRAM, tile maps (0x9800-0x9FFF) : chemin lent seulement pendant l'affichage
+    if (addr < 0xA000) {
+        if (memory[addr] != data) {
+            beforeVideoWrite();
+            memory[addr] = data;
         }
         return;
     }
 
-    // ⚡ TAC (0xFF07) - Gestion spéciale
-    if (addr == 0xFF07) {
-        if (timer) {
-            timer->writeTAC(data);
+    // External RAM (0xA000-0xBFFF)
+    if (addr >= 0xA000 && addr < 0xC000) {
+        uint32_t offset = mbc->writeRAM(addr, data, external_RAM, external_RAM_size);
+        if (offset != GB_MBC::NO_RAM) {
+            size_t page = offset / RAM_PAGE_SIZE;
+            ramDirtyPages[page >> 6] |= 1ULL << (page & 63);
+            if (hasBatterySave()) saveFile.markDirty(offset);
         }
         return;
     }
 
-    // I/O Registers (0xFF00-0xFF7F)
-    if (addr >= 0xFF00 && addr < 0xFF80) {
-        // Registre spécial: Boot ROM disable
+    // OAM (0xFE00-0xFE9F)
+    if (addr >= 0xFE00 && addr < 0xFEA0) {
         memory[addr] = data;
-        //
-        if (addr == 0xFF44) {
-            memory[0xFF44] = 0; // Toute écriture reset LY à 0
-            return;
-        }
-        //
-        if (addr == 0xFF50 && data != 0) {
-            boot_rom_enabled = false;
-            LOG_INFO("Boot ROM disabled");
-        }
-
         return;
     }
 
-    // HRAM (0xFF80-0xFFFE)
-    if (addr >= 0xFF80 && addr < 0xFFFF) {
-        memory[addr] = data;
+    // I/O Registers (0xFF00-0xFF7F)
+    if (addr >= 0xFF00 && addr < 0xFF80) {
+        const IOHandler& io = ioHandlers[addr & 0x7F];
+        if (io.write) {
+            io.write(io.ctx, addr, data);
+        } else {
+            memory[addr] = data;
+        }
         return;
     }
 
     // IE Register (0xFFFF)
     if (addr == 0xFFFF) {
-        memory[addr] = data;
+        interrupts.writeIE(data);
         return;
     }
 }
@@ -254,31 +461,10 @@ void GB_MMU::write_word(uint16_t addr, uint16_t data) {
 }
 
 void GB_MMU::handleMBCWrite(uint16_t addr, uint8_t data) {
-    // Pour l'instant, on gère seulement MBC1 de base
-
-    // RAM Enable (0x0000-0x1FFF)
-    if (addr < 0x2000) {
-        // TODO: Enable/disable RAM
-        return;
+    // Seul un changement de banque ou d'activation de la RAM demande de repointer les pages
+    if (mbc->write(addr, data)) {
+        mapROMPages();
+        mapRAMPages();
+        codeGeneration++;
     }
-
-    // ROM Bank Number (0x2000-0x3FFF)
-    if (addr >= 0x2000 && addr < 0x4000) {
-        uint8_t bank = data & 0x1F;  // 5 bits
-        if (bank == 0) bank = 1;     // Bank 0 pas accessible ici
-        current_ROM_bank = bank;
-        return;
-    }
-
-    // RAM Bank Number (0x4000-0x5FFF)
-    if (addr >= 0x4000 && addr < 0x6000) {
-        current_RAM_bank = data & 0x03;  // 2 bits
-        return;
-    }
-
-    // Banking Mode Select (0x6000-0x7FFF)
-    if (addr >= 0x6000 && addr < 0x8000) {
-        // TODO: ROM/RAM mode select
-        return;
-    }
-}
\ No newline at end of file
+}
@@ -5,57 +5,211 @@
 #include <string>
 #include <array>
 #include <vector>
+#include <memory>
+#include <algorithm>
 
-#include <core/gameboy/GB_Timer.h>
-class GB_Timer;
+#include "core/gameboy/GB_MBC.h"
+#include "core/gameboy/GB_SaveFile.h"
+#include "core/gameboy/GB_TileCache.h"
+#include "utils/FileUtils.h"
+
+class GB_Scheduler;
+class GB_Interrupts;
 
 class GB_MMU
 {
 public:
-    GB_MMU();
+    GB_MMU(GB_Scheduler& scheduler, GB_Interrupts& interrupts);
     ~GB_MMU() = default;
 
-    void write(uint16_t addr, uint8_t data);
+    // Chemin rapide : une page de 256 octets résolue par un pointeur, le reste
+    // (MBC, RAM externe, OAM, I/O, HRAM, IE) passe par readSlow/writeSlow
+    inline uint8_t read(uint16_t addr) const {
+        const uint8_t* page = readPages[addr >> 8];
+        return page ? page[addr & 0xFF] : readSlow(addr);
+    }
+    inline void write(uint16_t addr, uint8_t data) {
+        uint8_t* page = writePages[addr >> 8];
+        if (page) {
+            page[addr & 0xFF] = data;
+        } else {
+            writeSlow(addr, data);
+        }
+    }
     void write_word(uint16_t addr, uint16_t data);
-
-    uint8_t read(uint16_t addr) const;
     uint16_t read_word(uint16_t addr) const;
 
     bool loadROM(const std::string& path);
     bool loadBootROM(const std::string& path);
 
     void reset();
+    // Remet le MBC dans son état de mise sous tension (banque 1, RAM verrouillée)
+    // et interrompt une DMA en cours
+    void resetMapper();
+    // À appeler avant GB_Scheduler::reset : le MBC3 y acquiert le temps de son horloge
+    void prepareReset() { mbc->prepareReset(); }
+
+    // OAM DMA (0xFF46) : les 160 octets sont copiés d'un bloc à l'écriture du
+    // registre, puis le CPU n'accède plus qu'à 0xFF00-0xFFFF pendant DMA_CYCLES
+    static constexpr uint64_t DMA_CYCLES = 640;  // 160 M-cycles
+    bool isDMAActive() const { return dma_active; }
 
     const uint8_t* getMemoryPtr() const { return memory.data(); }
 
-    void dbg_serial() {
-        if (read(0xFF02) == 0x81) {
-            char c = static_cast<char>(read(0xFF01));
-            //LOG_DEBUG("%c", c);
-            printf("%c", c);  // ← Direct printf, pas LOG_DEBUG
-            fflush(stdout);
-            write(0xFF02, 0x0);
+    // RAM cartouche : allouée au chargement d'après l'octet 0x0149 de l'en-tête,
+    // projetée depuis le fichier .sav pour les cartouches à pile.
+    // Chaque écriture marque sa page de RAM_PAGE_SIZE octets dans le bitmap.
+    static constexpr size_t RAM_PAGE_SIZE = 0x100;
+
+    const uint8_t* getExternalRAM() const { return external_RAM; }
+    size_t getExternalRAMSize() const { return external_RAM_size; }
+    bool hasBatterySave() const { return saveFile.data() != nullptr; }
+    void endFrame() { saveFile.endFrame(); }
+    const std::vector<uint64_t>& getRAMDirtyPages() const { return ramDirtyPages; }
+    bool isRAMPageDirty(size_t page) const { return (ramDirtyPages[page >> 6] >> (page & 63)) & 1; }
+    void clearRAMDirtyPages() { std::fill(ramDirtyPages.begin(), ramDirtyPages.end(), 0); }
+
+    // Données des tuiles (0x8000-0x97FF) : ces pages restent en écriture sur le
+    // chemin lent, chaque octet modifié marque sa tuile pour le cache du PPU
+    const GB_TileCache::DirtyBitmap& getTileDirty() const { return tileDirty; }
+    void clearTileDirty() { tileDirty.fill(0); }
+
+    // Écritures VRAM pendant l'affichage (rendu différé du PPU) : quand le
+    // piège est armé, toute la VRAM passe par le chemin lent et le handler est
+    // appelé avant chaque octet modifié. L'OAM n'en a pas besoin, les sprites
+    // de chaque ligne sont relevés pendant son mode 2
+    using VideoWriteHandler = void (*)(void* ctx);
+
+    void setVideoWriteHandler(VideoWriteHandler handler, void* ctx) {
+        videoWriteHandler = handler;
+        videoWriteCtx = ctx;
+    }
+    void setVideoWriteTrap(bool enabled);
+
+    // Cache de blocs du CPU : identifiant de la page de 256 octets physiquement
+    // visible en addr (page d'une banque ROM, de la WRAM ou la HRAM).
+    // NO_CODE_PAGE quand le contenu ne se lit pas directement ou peut changer
+    // sans écriture du CPU (boot ROM, DMA, VRAM, RAM externe, echo, I/O)
+    static constexpr uint32_t NO_CODE_PAGE = ~0u;
+    static constexpr uint32_t WRAM_CODE_PAGES = 0x20;
+
+    inline uint32_t getCodePage(uint16_t addr) const {
+        const uint8_t page = addr >> 8;
+        if (addr < 0x8000) {
+            if (!readPages[page] || (page == 0x00 && boot_rom_enabled)) return NO_CODE_PAGE;
+            uint32_t bank = (addr < 0x4000) ? mbc->getROMBank0() : mbc->getROMBankN();
+            return bank * 0x40 + (page & 0x3F);
+        }
+        if (page >= 0xC0 && page < 0xE0) {
+            return readPages[page] ? romCodePages() + (page - 0xC0) : NO_CODE_PAGE;
         }
+        return addr >= 0xFF80 ? romCodePages() + WRAM_CODE_PAGES : NO_CODE_PAGE;
     }
+    size_t getCodePageCount() const { return romCodePages() + WRAM_CODE_PAGES + 1; }
+
+    // Une page de WRAM/HRAM qui contient du code décodé passe en écriture sur
+    // le chemin lent : la première écriture la rend au chemin rapide et appelle
+    // le handler avec l'identifiant de la page, pour jeter les blocs décodés
+    using CodeWriteHandler = void (*)(void* ctx, uint32_t codePage);
+
+    void setCodeWriteHandler(CodeWriteHandler handler, void* ctx) {
+        codeWriteHandler = handler;
+        codeWriteCtx = ctx;
+    }
+    void protectCodePage(uint8_t page);
+
+    // Incrémenté à chaque changement de ce que le CPU peut exécuter (banques
+    // ROM, boot ROM, DMA, page de code modifiée) : un bloc en cours s'arrête
+    uint32_t getCodeGeneration() const { return codeGeneration; }
 
-    void setTimer(GB_Timer* t) { timer = t; }
+    // Lus directement par le code du JIT (adresses stables, même contenu que read/write)
+    const uint8_t* const* getReadPageTable() const { return readPages.data(); }
+    uint8_t* const* getWritePageTable() const { return writePages.data(); }
+    uint8_t* getHRAM() { return memory.data() + 0xFF80; }
+    const uint64_t* getCodePageBitmap() const { return codePages.data(); }
+
+    // Registres I/O (0xFF00-0xFF7F) : chaque périphérique enregistre ses handlers.
+    // Sans handler, l'accès lit/écrit simplement la mémoire de fond.
+    using IOReadHandler = uint8_t (*)(void* ctx, uint16_t addr);
+    using IOWriteHandler = void (*)(void* ctx, uint16_t addr, uint8_t data);
+
+    void mapIO(uint16_t addr, IOReadHandler read, IOWriteHandler write, void* ctx);
+
+    // Écrit la mémoire de fond sans passer par les handlers
+    void directWrite(uint16_t addr, uint8_t value) {
+        memory[addr] = value;
+    }
     //!!!!
     void directWriteTAC(uint8_t value) {
         memory[0xFF07] = value;
     }
+    // LY est en lecture seule pour le CPU (une écriture le remet à 0)
+    void directWriteLY(uint8_t value) {
+        memory[0xFF44] = value;
+    }
 
 private:
     std::array<uint8_t, 0x10000> memory{};  // 64KB
 
-    std::vector<uint8_t> external_RAM;
-    std::vector<uint8_t> rom_data;
-    std::vector<uint8_t> boot_rom;
+    uint8_t* external_RAM = nullptr;       // external_RAM_buffer ou le fichier .sav
+    size_t external_RAM_size = 0;
+    std::vector<uint8_t> external_RAM_buffer;
+    GB_SaveFile saveFile;
+    std::vector<uint64_t> ramDirtyPages;   // 1 bit par page de RAM_PAGE_SIZE
+    GB_TileCache::DirtyBitmap tileDirty{}; // 1 bit par tuile
+    // Images partagées : une seule copie pour toutes les instances
+    FileUtils::RomImagePtr rom_image;
+    FileUtils::RomImagePtr boot_rom;
+    const uint8_t* rom_data = nullptr;
+    size_t rom_size = 0;
 
-    uint8_t current_ROM_bank = 1;
-    uint8_t current_RAM_bank = 0;
     bool boot_rom_enabled = true;
+    bool dma_active = false;
+    bool video_trap = false;
+
+    VideoWriteHandler videoWriteHandler = nullptr;
+    void* videoWriteCtx = nullptr;
+
+    inline void beforeVideoWrite() {
+        if (video_trap && videoWriteHandler) videoWriteHandler(videoWriteCtx);
+    }
+
+    CodeWriteHandler codeWriteHandler = nullptr;
+    void* codeWriteCtx = nullptr;
+    std::array<uint64_t, 4> codePages{};  // 1 bit par page protégée (addr >> 8)
+    uint32_t codeGeneration = 0;
 
-    GB_Timer* timer = nullptr;
+    uint32_t romCodePages() const { return static_cast<uint32_t>((rom_size + 0xFF) >> 8); }
+    bool isCodePage(uint8_t page) const { return (codePages[page >> 6] >> (page & 63)) & 1; }
+    void releaseCodePage(uint8_t page);
+
+    GB_Scheduler& scheduler;
+    GB_Interrupts& interrupts;
+    std::unique_ptr<GB_MBC> mbc;
+
+    struct IOHandler {
+        IOReadHandler read = nullptr;
+        IOWriteHandler write = nullptr;
+        void* ctx = nullptr;
+    };
+
+    std::array<IOHandler, 0x80> ioHandlers{};
+
+    // Table des pages (addr >> 8) : nullptr = chemin lent
+    std::array<const uint8_t*, 256> readPages{};
+    std::array<uint8_t*, 256> writePages{};
+
+    uint8_t readSlow(uint16_t addr) const;
+    void writeSlow(uint16_t addr, uint8_t data);
+
+    void rebuildPageTables();
+    void mapROMPages();
+    void mapRAMPages();
+
+    void allocateExternalRAM(const std::string& romPath, uint8_t cartridgeType, uint8_t ramSizeCode);
 
     void handleMBCWrite(uint16_t addr, uint8_t data);
+
+    void startDMA(uint8_t source);
+    void endDMA();
 };
\ No newline at end of file
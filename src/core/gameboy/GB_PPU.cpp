@@ -1,146 +1,299 @@
 #include "core/gameboy/GB_PPU.h"
+#include "core/gameboy/GB_ScanlineRenderer.h"
+#include "core/gameboy/GB_FifoRenderer.h"
 #include "core/gameboy/GB_MMU.h"
+#include "core/gameboy/GB_Scheduler.h"
+#include "core/gameboy/GB_Interrupts.h"
 #include "utils/Logger.h"
 
-GB_PPU::GB_PPU(GB_MMU& mem) : mmu(mem) {
+#include <algorithm>
+
+std::unique_ptr<GB_PPU> GB_PPU::create(GB_PPUModel model, GB_MMU& mmu,
+                                       GB_Scheduler& scheduler, GB_Interrupts& interrupts) {
+    switch (model) {
+        case GB_PPUModel::PixelFifo:
+            return std::make_unique<GB_PPUCore<GB_FifoRenderer>>(mmu, scheduler, interrupts);
+        case GB_PPUModel::Scanline:
+            break;
+    }
+    return std::make_unique<GB_PPUCore<GB_ScanlineRenderer>>(mmu, scheduler, interrupts);
+}
+
+// ============================================================================
+// État partagé
+// ============================================================================
+
+GB_PPUState::RasterRegisters GB_PPUState::readRasterRegisters() const {
+    RasterRegisters regs;
+    for (size_t reg = 0; reg < RASTER_REG_COUNT; ++reg) {
+        regs[reg] = mmu.getMemoryPtr()[RASTER_REG_ADDR[reg]];
+    }
+    return regs;
+}
+
+const uint8_t* GB_PPUState::vram() const {
+    return mmu.getMemoryPtr() + 0x8000;
+}
+
+void GB_PPUState::updateTileCache() {
+    tileCache.update(vram(), mmu.getTileDirty());
+    mmu.clearTileDirty();
+}
+
+void GB_PPUState::scanOAM(uint8_t ly, uint8_t lcdc) {
+    int height = (lcdc & 0x04) ? 16 : 8;
+    int line = ly + 16;  // Y de l'OAM décalé de 16
+    const uint8_t* oam = mmu.getMemoryPtr() + 0xFE00;
+
+    LineSprites& selected = lineSprites[ly];
+    selected.count = 0;
+    for (int i = 0; i < 40 && selected.count < MAX_SPRITES_PER_LINE; i++) {
+        const uint8_t* entry = oam + i * 4;
+        if (line < entry[0] || line >= entry[0] + height) continue;
+
+        // Insertion triée sur X ; à X égal, l'entrée de l'OAM la plus basse reste devant
+        Sprite sprite = {entry[0], entry[1], entry[2], entry[3]};
+        int pos = selected.count++;
+        while (pos > 0 && selected.sprites[pos - 1].x > sprite.x) {
+            selected.sprites[pos] = selected.sprites[pos - 1];
+            pos--;
+        }
+        selected.sprites[pos] = sprite;
+    }
+}
+
+const uint8_t* GB_PPUState::spriteRow(const Sprite& sprite, uint8_t ly, int height) const {
+    int row = ly + 16 - sprite.y;
+    if (sprite.flags & 0x40) row = height - 1 - row;  // Miroir vertical
+
+    // 8x16 : le bit 0 du numéro de tuile est ignoré, la seconde tuile fait le bas
+    uint16_t tile = sprite.tile;
+    if (height == 16) tile = (tile & 0xFE) | (row >> 3);
+    return tileCache.getRow(tile, row & 7);
+}
+
+// ============================================================================
+// Séquenceur
+// ============================================================================
+
+template<class Renderer>
+GB_PPUCore<Renderer>::GB_PPUCore(GB_MMU& mem, GB_Scheduler& sched, GB_Interrupts& irq)
+    : mmu(mem), scheduler(sched), interrupts(irq), state(mem), renderer(state) {
+    scheduler.setHandler(GB_Event::PPU, [this](uint64_t when) { onModeEvent(when); });
+
+    // LCDC : le bit 7 allume/éteint l'écran
+    mmu.mapIO(0xFF40, nullptr,
+        [](void* ctx, uint16_t, uint8_t data) { static_cast<GB_PPUCore*>(ctx)->writeLCDC(data); },
+        this);
+
+    // SCY, SCX, BGP, OBP0, OBP1, WY, WX : transmis au renderer
+    mapRasterRegisters(std::make_index_sequence<GB_PPUState::RASTER_REG_COUNT - GB_PPUState::SCY>{});
+
+    // STAT : mode et coïncidence tenus par le PPU
+    mmu.mapIO(0xFF41,
+        [](void* ctx, uint16_t) { return static_cast<GB_PPUCore*>(ctx)->readSTAT(); },
+        [](void* ctx, uint16_t, uint8_t data) { static_cast<GB_PPUCore*>(ctx)->writeSTAT(data); },
+        this);
+
+    // LY est en lecture seule pour le CPU : toute écriture le remet à 0
+    mmu.mapIO(0xFF44, nullptr,
+        [](void* ctx, uint16_t, uint8_t) { static_cast<GB_PPUCore*>(ctx)->mmu.directWriteLY(0); },
+        this);
+
+    // LYC : la coïncidence est réévaluée immédiatement
+    mmu.mapIO(0xFF45, nullptr,
+        [](void* ctx, uint16_t, uint8_t data) { static_cast<GB_PPUCore*>(ctx)->writeLYC(data); },
+        this);
     reset();
 }
 
-void GB_PPU::reset() {
-    framebuffer.fill(0xFF);
-    scanlineCounter = 0;
-    currentScanline = 0;
-    mode = PPUMode::OAMScan;
+template<class Renderer>
+void GB_PPUCore<Renderer>::reset() {
+    state.framebuffer.fill(0xFF);
+    state.tileCache.decodeAll(state.vram());
+    mmu.clearTileDirty();
+    state.currentScanline = 0;
+    state.windowLine = 0;
+    state.lineSprites.fill({});
+    renderer.reset();
     frameReady = false;
-    
-    LOG_DEBUG("GB PPU reset");
+    statEnable = 0;
+    statLine = false;
+    lyc = 0;
+    mmu.directWriteLY(0);
+    mmu.directWrite(0xFF45, 0);
+
+    // État laissé par la Boot ROM : écran allumé, fond actif
+    mmu.directWrite(0xFF40, 0x91);
+    mmu.directWrite(0xFF47, 0xFC);
+    lcdEnabled = true;
+    renderer.beginFrame();
+    startLine(scheduler.now());
+
+    LOG_DEBUG("GB PPU reset ({})", Renderer::NAME);
 }
 
-void GB_PPU::step(int cycles) {
-    scanlineCounter += cycles;
-    uint8_t stat = mmu.read(0xFF41);
+template<class Renderer>
+void GB_PPUCore<Renderer>::enterMode(Mode newMode, uint64_t nextEvent) {
+    state.mode = newMode;
+    updateStatLine();
+    scheduler.schedule(GB_Event::PPU, nextEvent);
+}
 
-    switch (mode) {
-        case PPUMode::OAMScan:
-            stat = (stat & ~0x03) | 0x02;
-            if (scanlineCounter >= 80) {
-                scanlineCounter -= 80;
-                mode = PPUMode::Drawing;
-            }
+template<class Renderer>
+void GB_PPUCore<Renderer>::startLine(uint64_t when) {
+    lineStart = when;
+    enterMode(Mode::OAMScan, when + OAM_SCAN_CYCLES);
+}
+
+template<class Renderer>
+void GB_PPUCore<Renderer>::onModeEvent(uint64_t when) {
+    switch (state.mode) {
+        case Mode::OAMScan:
+            state.scanOAM(state.currentScanline, mmu.read(0xFF40));
+            drawingStart = when;
+            enterMode(Mode::Drawing, when + renderer.beginDrawing());
             break;
-            
-        case PPUMode::Drawing:
-            stat = (stat & ~0x03) | 0x03;
-            if (scanlineCounter >= 172) {
-                scanlineCounter -= 172;
-                mode = PPUMode::HBlank;
-                renderScanline();
-            }
+
+        case Mode::Drawing:
+            renderer.endDrawing();
+            // Le HBlank absorbe la durée variable du mode 3
+            enterMode(Mode::HBlank, lineStart + SCANLINE_CYCLES);
             break;
-            
-        case PPUMode::HBlank:
-            stat = (stat & ~0x03) | 0x00;
-            if (scanlineCounter >= 204) {
-                scanlineCounter -= 204;
-                currentScanline++;
-                mmu.write(0xFF44, currentScanline);
-                
-                if (currentScanline == 144) {
-                    mode = PPUMode::VBlank;
-                    frameReady = true;
-                    
-                    // Déclenche VBlank interrupt
-                    uint8_t IF = mmu.read(0xFF0F);
-                    mmu.write(0xFF0F, IF | 0x01);
-                } else {
-                    mode = PPUMode::OAMScan;
-                }
+
+        case Mode::HBlank:
+            setLY(state.currentScanline + 1);
+
+            if (state.currentScanline == 144) {
+                renderer.endFrame();
+                frameReady = true;
+
+                // Déclenche VBlank interrupt
+                interrupts.request(GB_Interrupts::VBLANK);
+
+                enterMode(Mode::VBlank, when + SCANLINE_CYCLES);
+            } else {
+                startLine(when);
             }
             break;
-            
-        case PPUMode::VBlank:
-            stat = (stat & ~0x03) | 0x01;
-            if (scanlineCounter >= 456) {
-                scanlineCounter -= 456;
-                currentScanline++;
-                mmu.write(0xFF44, currentScanline);
-                
-                if (currentScanline > 153) {
-                    currentScanline = 0;
-                    mode = PPUMode::OAMScan;
-                }
+
+        case Mode::VBlank:
+            if (state.currentScanline == 153) {
+                setLY(0);
+                state.windowLine = 0;
+                renderer.beginFrame();
+                startLine(when);
+            } else {
+                setLY(state.currentScanline + 1);
+                enterMode(Mode::VBlank, when + SCANLINE_CYCLES);
             }
             break;
     }
-    mmu.write(0xFF41, stat);
 }
 
-void GB_PPU::renderScanline() {
-    renderBackground();
+// LY change toujours avec le mode : la ligne STAT est réévaluée par enterMode
+template<class Renderer>
+void GB_PPUCore<Renderer>::setLY(uint8_t ly) {
+    state.currentScanline = ly;
+    mmu.directWriteLY(ly);
 }
 
-void GB_PPU::renderBackground() {
-    uint8_t lcdc = mmu.read(0xFF40);
-    
-    if ((lcdc & 0x80) == 0) {
-        return;  // LCD OFF
+template<class Renderer>
+void GB_PPUCore<Renderer>::writeLCDC(uint8_t value) {
+    bool enable = (value & 0x80) != 0;
+    if (enable == lcdEnabled) {
+        writeRasterRegister(GB_PPUState::LCDC, value);
+        return;
+    }
+    lcdEnabled = enable;
+
+    if (enable) {
+        // L'écran repart de la ligne 0 à partir de maintenant
+        mmu.directWrite(0xFF40, value);
+        setLY(0);
+        state.windowLine = 0;
+        renderer.beginFrame();
+        startLine(scheduler.now());
+    } else {
+        // Écran éteint : LY = 0, mode 0, plus aucun événement planifié.
+        // Les lignes déjà passées sont dessinées avec l'ancien LCDC.
+        renderer.endFrame();
+        mmu.directWrite(0xFF40, value);
+        scheduler.cancel(GB_Event::PPU);
+        setLY(0);
+        state.mode = Mode::HBlank;
+        updateStatLine();
     }
-    
-    uint8_t scrollY = mmu.read(0xFF42);
-    uint8_t scrollX = mmu.read(0xFF43);
-    
-    uint16_t tileMapBase = (lcdc & 0x08) ? 0x9C00 : 0x9800;
-    bool unsignedTileData = (lcdc & 0x10) != 0;
-    uint16_t tileDataBase = unsignedTileData ? 0x8000 : 0x8800;
-    
-    uint8_t y = currentScanline + scrollY;
-    uint8_t tileRow = y / 8;
-    uint8_t pixelY = y % 8;
-    
-    for (int x = 0; x < 160; x++) {
-        uint8_t pixelX = (x + scrollX) % 256;
-        uint8_t tileCol = pixelX / 8;
-        uint8_t tilePixelX = pixelX % 8;
-        
-        uint16_t tileMapAddr = tileMapBase + (tileRow * 32) + tileCol;
-        uint8_t tileIndex = mmu.read(tileMapAddr);
-        
-        uint16_t tileAddr;
-        if (unsignedTileData) {
-            tileAddr = tileDataBase + (tileIndex * 16);
-        } else {
-            int8_t signedIndex = static_cast<int8_t>(tileIndex);
-            tileAddr = tileDataBase + ((signedIndex + 128) * 16);
+}
+
+template<class Renderer>
+uint8_t GB_PPUCore<Renderer>::readSTAT() const {
+    uint8_t coincidence = (state.currentScanline == lyc) ? 0x04 : 0;
+    uint8_t modeBits = lcdEnabled ? static_cast<uint8_t>(state.mode) : 0;
+    return 0x80 | statEnable | coincidence | modeBits;
+}
+
+template<class Renderer>
+void GB_PPUCore<Renderer>::writeSTAT(uint8_t value) {
+    statEnable = value & 0x78;
+    updateStatLine();
+}
+
+template<class Renderer>
+void GB_PPUCore<Renderer>::writeLYC(uint8_t value) {
+    lyc = value;
+    mmu.directWrite(0xFF45, value);
+    updateStatLine();
+}
+
+template<class Renderer>
+void GB_PPUCore<Renderer>::updateStatLine() {
+    bool line = false;
+    if (lcdEnabled) {
+        switch (state.mode) {
+            case Mode::HBlank:  line = (statEnable & 0x08) != 0; break;
+            case Mode::VBlank:  line = (statEnable & 0x10) != 0; break;
+            case Mode::OAMScan: line = (statEnable & 0x20) != 0; break;
+            case Mode::Drawing: break;
         }
+        if ((statEnable & 0x40) && state.currentScanline == lyc) line = true;
+    }
 
-        uint8_t byte1 = mmu.read(tileAddr + (pixelY * 2));
-        uint8_t byte2 = mmu.read(tileAddr + (pixelY * 2) + 1);
-
-        int bitPos = 7 - tilePixelX;
-        uint8_t colorBit1 = (byte1 >> bitPos) & 1;
-        uint8_t colorBit2 = (byte2 >> bitPos) & 1;
-        uint8_t colorId = (colorBit2 << 1) | colorBit1;
-        
-        uint8_t palette = mmu.read(0xFF47);
-        uint8_t color = (palette >> (colorId * 2)) & 0x03;
-        
-        setPixel(x, currentScanline, color);
+    if (line && !statLine) {
+        interrupts.request(GB_Interrupts::STAT);
+    }
+    statLine = line;
+}
+
+template<class Renderer>
+template<uint8_t REG>
+void GB_PPUCore<Renderer>::onRasterWrite(void* ctx, uint16_t, uint8_t data) {
+    static_cast<GB_PPUCore*>(ctx)->writeRasterRegister(static_cast<RasterReg>(REG), data);
+}
+
+template<class Renderer>
+template<std::size_t... I>
+void GB_PPUCore<Renderer>::mapRasterRegisters(std::index_sequence<I...>) {
+    constexpr uint8_t first = GB_PPUState::SCY;
+    (mmu.mapIO(GB_PPUState::RASTER_REG_ADDR[first + I], nullptr, &GB_PPUCore::onRasterWrite<first + I>, this), ...);
+}
+
+template<class Renderer>
+void GB_PPUCore<Renderer>::writeRasterRegister(RasterReg reg, uint8_t value) {
+    mmu.directWrite(GB_PPUState::RASTER_REG_ADDR[reg], value);
+
+    if constexpr (Renderer::VARIABLE_DRAWING) {
+        // Écriture pendant le mode 3 : la fin de la ligne dépend de la nouvelle valeur
+        if (state.mode == Mode::Drawing) {
+            uint64_t now = scheduler.now();
+            int dot = static_cast<int>(now - drawingStart);
+            uint64_t drawingEnd = drawingStart + renderer.midlineWrite(reg, value, dot);
+            scheduler.schedule(GB_Event::PPU, std::max(drawingEnd, now));
+        }
+    } else {
+        renderer.rasterWrite(reg, value);
     }
 }
 
-void GB_PPU::setPixel(int x, int y, uint8_t colorId) {
-    if (x < 0 || x >= 160 || y < 0 || y >= 144) return;
-    
-    static const uint8_t colors[4][3] = {
-        {155, 188, 15},   // 0: Blanc
-        {139, 172, 15},   // 1: Gris clair
-        {48, 98, 48},     // 2: Gris foncé
-        {15, 56, 15}      // 3: Noir
-    };
-    
-    int index = (y * 160 + x) * 4;
-    framebuffer[index + 0] = colors[colorId][0];
-    framebuffer[index + 1] = colors[colorId][1];
-    framebuffer[index + 2] = colors[colorId][2];
-    framebuffer[index + 3] = 255;
-}
\ No newline at end of file
+template class GB_PPUCore<GB_ScanlineRenderer>;
+template class GB_PPUCore<GB_FifoRenderer>;
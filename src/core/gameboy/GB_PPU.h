@@ -1,44 +1,203 @@
 #pragma once
 #include "common/Types.h"
+#include "core/gameboy/GB_TileCache.h"
+#include "core/gameboy/GB_Compositor.h"
 #include <array>
+#include <memory>
+#include <utility>
 
 class GB_MMU;
+class GB_Scheduler;
+class GB_Interrupts;
 
+// Modèle de PPU, choisi une fois pour toutes à la construction du Gameboy
+enum class GB_PPUModel {
+    Scanline,   // Rendu par ligne (ou par frame en différé), mode 3 de durée fixe
+    PixelFifo   // FIFO de pixels au point près : mode 3 de durée variable, écritures en milieu de ligne
+};
+
+// Interface vue par le Gameboy. Toute l'émulation est dans GB_PPUCore<Renderer> :
+// seuls ces appels, une fois par frame, passent par la vtable.
 class GB_PPU {
 public:
-    GB_PPU(GB_MMU& mmu);
+    virtual ~GB_PPU() = default;
 
-    void reset();
-    void step(int cycles);
+    static std::unique_ptr<GB_PPU> create(GB_PPUModel model, GB_MMU& mmu,
+                                          GB_Scheduler& scheduler, GB_Interrupts& interrupts);
 
-    const uint8_t* getFramebuffer() const { return framebuffer.data(); }
+    virtual void reset() = 0;
+    virtual const char* getName() const = 0;
 
-    bool isFrameReady() const { return frameReady; }
-    void clearFrameReady() { frameReady = false; }
+    virtual const uint8_t* getFramebuffer() const = 0;
 
-private:
-    GB_MMU& mmu;
+    virtual bool isFrameReady() const = 0;
+    virtual void clearFrameReady() = 0;
 
-    // 160x144 pixels * 4 (RGBA)
-    std::array<uint8_t, 160 * 144 * 4> framebuffer{};
+    virtual bool isLCDEnabled() const = 0;
+};
 
-    bool frameReady = false;
+// État partagé entre le séquenceur (GB_PPUCore) et son renderer
+struct GB_PPUState {
+    explicit GB_PPUState(GB_MMU& mmu) : mmu(mmu) {}
 
-    // LCD state
-    int scanlineCounter = 0;
-    uint8_t currentScanline = 0;
-
-    enum class PPUMode {
+    enum class Mode : uint8_t {
         HBlank = 0,
         VBlank = 1,
         OAMScan = 2,
         Drawing = 3
     };
 
-    PPUMode mode = PPUMode::OAMScan;
+    // Registres lus par le rendu d'une ligne
+    enum RasterReg : uint8_t {
+        LCDC = 0,
+        SCY,
+        SCX,
+        BGP,
+        OBP0,
+        OBP1,
+        WY,
+        WX,
+        RASTER_REG_COUNT
+    };
+
+    using RasterRegisters = std::array<uint8_t, RASTER_REG_COUNT>;
+    static constexpr uint16_t RASTER_REG_ADDR[RASTER_REG_COUNT] = {
+        0xFF40, 0xFF42, 0xFF43, 0xFF47, 0xFF48, 0xFF49, 0xFF4A, 0xFF4B
+    };
+
+    // Sprites retenus par le scan OAM (mode 2), triés par priorité DMG :
+    // X croissant puis ordre dans l'OAM. Une liste par ligne : en rendu différé,
+    // la ligne est dessinée bien après son scan
+    static constexpr int MAX_SPRITES_PER_LINE = 10;
+
+    struct Sprite {
+        uint8_t y;
+        uint8_t x;
+        uint8_t tile;
+        uint8_t flags;
+    };
+
+    struct LineSprites {
+        std::array<Sprite, MAX_SPRITES_PER_LINE> sprites{};
+        int count = 0;
+    };
+
+    GB_MMU& mmu;
+
+    // 160x144 pixels * 4 (RGBA)
+    std::array<uint8_t, 160 * 144 * 4> framebuffer{};
+
+    std::array<LineSprites, 144> lineSprites{};
+    GB_TileCache tileCache;
+    GB_Compositor compositor;
+
+    Mode mode = Mode::OAMScan;
+    uint8_t currentScanline = 0;
+    uint8_t windowLine = 0;  // Compteur interne : n'avance que sur les lignes où la fenêtre est dessinée
+
+    RasterRegisters readRasterRegisters() const;
+    const uint8_t* vram() const;
+
+    // Redécode les tuiles écrites depuis le dernier rendu
+    void updateTileCache();
+    void scanOAM(uint8_t ly, uint8_t lcdc);
+
+    uint8_t* lineRGBA(uint8_t ly) { return framebuffer.data() + ly * 160 * 4; }
+
+    // Ligne de sprite dans la tuile : miroir vertical et seconde tuile des 8x16
+    const uint8_t* spriteRow(const Sprite& sprite, uint8_t ly, int height) const;
+
+    // Tuile du cache désignée par un index de la carte du fond ou de la fenêtre.
+    // Mode 0x8800 (LCDC bit 4 à 0) : index signé, la tuile 0 est la 256e de la VRAM
+    static uint16_t bgTile(uint8_t lcdc, uint8_t tileIndex) {
+        return (lcdc & 0x10) ? tileIndex : 256 + static_cast<int8_t>(tileIndex);
+    }
+
+    // Colonne de l'écran où commence la fenêtre (WX est décalé de 7). Négative
+    // pour WX < 7 : la fenêtre commence hors écran, ses premiers pixels sont coupés
+    static int windowX(uint8_t wx) { return wx - 7; }
+};
+
+// Séquenceur des modes du PPU, paramétré par son renderer. Le renderer est
+// appelé statiquement ; ce qui ne concerne qu'un modèle est écarté à la
+// compilation (if constexpr), l'autre n'en paie rien.
+//
+// Un renderer fournit :
+//   static constexpr const char* NAME;
+//   static constexpr bool VARIABLE_DRAWING;  // Durée du mode 3 calculée par ligne
+//   explicit Renderer(GB_PPUState&);
+//   void reset();
+//   void beginFrame();               // Ligne 0, début du mode 2
+//   void endFrame();                 // Entrée en VBlank ou écran éteint
+//   int  beginDrawing();             // Début du mode 3, renvoie sa durée en cycles
+//   void endDrawing();               // Fin du mode 3
+// et selon VARIABLE_DRAWING :
+//   void rasterWrite(RasterReg, uint8_t);                  // false : toute écriture de registre
+//   int  midlineWrite(RasterReg, uint8_t, int dot);       // true : écriture pendant le mode 3,
+//                                                         // renvoie la nouvelle durée
+template<class Renderer>
+class GB_PPUCore final : public GB_PPU {
+public:
+    GB_PPUCore(GB_MMU& mmu, GB_Scheduler& scheduler, GB_Interrupts& interrupts);
+
+    void reset() override;
+    const char* getName() const override { return Renderer::NAME; }
+
+    const uint8_t* getFramebuffer() const override { return state.framebuffer.data(); }
+
+    bool isFrameReady() const override { return frameReady; }
+    void clearFrameReady() override { frameReady = false; }
+
+    bool isLCDEnabled() const override { return lcdEnabled; }
+
+    Renderer& getRenderer() { return renderer; }
+
+private:
+    using Mode = GB_PPUState::Mode;
+    using RasterReg = GB_PPUState::RasterReg;
+
+    GB_MMU& mmu;
+    GB_Scheduler& scheduler;
+    GB_Interrupts& interrupts;
+
+    GB_PPUState state;
+    Renderer renderer;
+
+    bool frameReady = false;
+    bool lcdEnabled = true;
+
+    // STAT : seuls les bits d'activation (3-6) sont stockés, le mode et la
+    // coïncidence LY=LYC sont recomposés à la lecture
+    uint8_t statEnable = 0;
+    uint8_t lyc = 0;
+    bool statLine = false;   // Ligne d'interruption STAT (OU des sources actives)
+
+    uint64_t lineStart = 0;     // Début du mode 2 de la ligne courante
+    uint64_t drawingStart = 0;  // Début du mode 3 de la ligne courante
+
+    // Durées des modes (en cycles)
+    static constexpr int OAM_SCAN_CYCLES = 80;
+    static constexpr int SCANLINE_CYCLES = 456;
+
+    // Appelé par le scheduler à chaque changement de mode
+    void onModeEvent(uint64_t when);
+    // Planifié depuis l'instant théorique de l'événement : pas de dérive
+    void enterMode(Mode newMode, uint64_t nextEvent);
+    void startLine(uint64_t when);
+    void setLY(uint8_t ly);
+
+    // Registres LCDC / STAT / LYC (handlers I/O)
+    void writeLCDC(uint8_t value);
+    uint8_t readSTAT() const;
+    void writeSTAT(uint8_t value);
+    void writeLYC(uint8_t value);
+
+    // Une interruption STAT n'est levée que sur un front montant de la ligne
+    void updateStatLine();
+
+    void writeRasterRegister(RasterReg reg, uint8_t value);
 
-    // Rendering
-    void renderScanline();
-    void renderBackground();
-    void setPixel(int x, int y, uint8_t colorId);
-};
\ No newline at end of file
+    // Un handler I/O par registre de rendu, le registre fixé à la compilation
+    template<uint8_t REG> static void onRasterWrite(void* ctx, uint16_t addr, uint8_t data);
+    template<std::size_t... I> void mapRasterRegisters(std::index_sequence<I...>);
+};
@@ -0,0 +1,215 @@
+#include "core/gameboy/GB_SaveFile.h"
+#include "utils/Logger.h"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+GB_SaveFile::~GB_SaveFile() {
+    close();
+}
+
+bool GB_SaveFile::open(const std::string& savePath, size_t size) {
+    close();
+    if (size == 0) return false;
+
+    path = savePath;
+
+#ifdef _WIN32
+    pageShift = 12;
+
+    buffer.assign(size, 0);
+    std::ifstream in(path, std::ios::binary);
+    if (in.is_open()) {
+        in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size));
+    }
+
+    // Crée le fichier à la bonne taille pour que les écritures de pages puissent s'y placer
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            LOG_ERROR("Failed to open save file: {}", path);
+            buffer.clear();
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(size));
+    }
+
+    // Gardé ouvert : les synchros de fin de frame ne rouvrent pas le fichier
+    file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open()) {
+        LOG_ERROR("Failed to open save file: {}", path);
+        buffer.clear();
+        return false;
+    }
+    ram = buffer.data();
+#else
+    long systemPage = sysconf(_SC_PAGESIZE);
+    pageShift = 0;
+    while ((1L << pageShift) < systemPage) ++pageShift;
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open save file: {}", path);
+        return false;
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || (static_cast<size_t>(st.st_size) < size && ftruncate(fd, size) != 0)) {
+        LOG_ERROR("Failed to resize save file: {}", path);
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        LOG_ERROR("Failed to map save file: {}", path);
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    ram = static_cast<uint8_t*>(mapping);
+#endif
+
+    ramSize = size;
+
+    size_t pageCount = ((size - 1) >> pageShift) + 1;
+    dirtyWords = (pageCount + 63) / 64;
+    dirty = std::make_unique<std::atomic<uint64_t>[]>(dirtyWords);
+    for (size_t i = 0; i < dirtyWords; ++i) dirty[i].store(0, std::memory_order_relaxed);
+
+    stopping = false;
+    lastFlush = std::chrono::steady_clock::now();
+    flusher = std::thread(&GB_SaveFile::flushLoop, this);
+
+    LOG_INFO("Save file: {} ({} bytes)", path, size);
+    return true;
+}
+
+void GB_SaveFile::close() {
+    if (!ram) return;
+
+    // Le thread de fond termine les écritures déjà confiées avant de s'arrêter
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (flusher.joinable()) flusher.join();
+
+    // Dernière synchro, sur le thread appelant : plus rien n'écrit dans la RAM
+    for (const PendingWrite& pages : collectDirtyPages()) {
+        writePages(pages);
+    }
+
+#ifdef _WIN32
+    file.close();
+    buffer.clear();
+#else
+    munmap(ram, ramSize);
+    ::close(fd);
+    fd = -1;
+#endif
+
+    ram = nullptr;
+    ramSize = 0;
+    dirty.reset();
+    dirtyWords = 0;
+}
+
+void GB_SaveFile::endFrame() {
+    if (!ram) return;
+
+    // Limité à une synchro par intervalle, quel que soit le rythme des écritures
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastFlush < FLUSH_INTERVAL) return;
+    lastFlush = now;
+
+    std::vector<PendingWrite> writes = collectDirtyPages();
+    if (writes.empty()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (PendingWrite& pages : writes) {
+            staged.push_back(std::move(pages));
+        }
+    }
+    wake.notify_one();
+}
+
+void GB_SaveFile::flushLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || !staged.empty(); });
+        if (staged.empty()) break;
+
+        std::vector<PendingWrite> writes;
+        writes.swap(staged);
+
+        lock.unlock();
+        for (const PendingWrite& pages : writes) {
+            writePages(pages);
+        }
+        lock.lock();
+    }
+}
+
+std::vector<GB_SaveFile::PendingWrite> GB_SaveFile::collectDirtyPages() {
+    // Regroupe les pages sales consécutives en une seule écriture
+    std::vector<PendingWrite> writes;
+    size_t runStart = 0;
+    size_t runLength = 0;
+
+    auto addRun = [&]() {
+        size_t offset = runStart << pageShift;
+        size_t length = std::min(runLength << pageShift, ramSize - offset);
+        PendingWrite pages{offset, length, {}};
+#ifdef _WIN32
+        // Copie prise sur le thread d'émulation : le thread de fond ne lit jamais le buffer
+        pages.bytes.assign(ram + offset, ram + offset + length);
+#endif
+        writes.push_back(std::move(pages));
+        runLength = 0;
+    };
+
+    for (size_t word = 0; word < dirtyWords; ++word) {
+        uint64_t bits = dirty[word].exchange(0, std::memory_order_acq_rel);
+        for (size_t bit = 0; bit < 64; ++bit) {
+            size_t page = word * 64 + bit;
+            if (bits & (1ULL << bit)) {
+                if (runLength == 0) runStart = page;
+                ++runLength;
+            } else if (runLength > 0) {
+                addRun();
+            }
+        }
+    }
+
+    if (runLength > 0) {
+        addRun();
+    }
+    return writes;
+}
+
+void GB_SaveFile::writePages(const PendingWrite& pages) {
+#ifdef _WIN32
+    file.seekp(static_cast<std::streamoff>(pages.offset));
+    file.write(reinterpret_cast<const char*>(pages.bytes.data()), static_cast<std::streamsize>(pages.length));
+    file.flush();
+    if (!file.good()) {
+        LOG_ERROR("Failed to write save file: {}", path);
+        file.clear();
+    }
+#else
+    // msync ne fait que demander au noyau d'écrire la projection
+    if (msync(ram + pages.offset, pages.length, MS_SYNC) != 0) {
+        LOG_ERROR("Failed to sync save file: {}", path);
+    }
+#endif
+}
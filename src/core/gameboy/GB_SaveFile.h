@@ -0,0 +1,84 @@
+#pragma once
+#include "common/types.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#ifdef _WIN32
+#include <fstream>
+#endif
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Fichier .sav d'une cartouche à pile. Le thread d'émulation marque les pages
+// modifiées (bitmap atomique) et, en fin de frame au plus une fois par
+// FLUSH_INTERVAL, confie les pages sales à un thread de fond qui fait les
+// entrées/sorties : le thread d'émulation n'attend jamais le disque.
+// Avec mmap la RAM cartouche *est* le fichier et le thread de fond fait un
+// msync ; sous Windows (buffer en mémoire), les pages sont copiées en fin de
+// frame et le thread de fond écrit cette copie, jamais le buffer lui-même.
+class GB_SaveFile {
+public:
+    static constexpr auto FLUSH_INTERVAL = std::chrono::seconds(1);
+
+    GB_SaveFile() = default;
+    ~GB_SaveFile();
+
+    GB_SaveFile(const GB_SaveFile&) = delete;
+    GB_SaveFile& operator=(const GB_SaveFile&) = delete;
+
+    // Ouvre (ou crée) le fichier et l'agrandit à size octets si besoin
+    bool open(const std::string& path, size_t size);
+    void close();
+
+    uint8_t* data() const { return ram; }
+    size_t size() const { return ramSize; }
+
+    // Appelé par le MMU à chaque écriture en RAM cartouche (ne bloque jamais)
+    inline void markDirty(size_t offset) {
+        size_t page = offset >> pageShift;
+        dirty[page >> 6].fetch_or(1ULL << (page & 63), std::memory_order_relaxed);
+    }
+
+    // Fin de frame, sur le thread d'émulation : si FLUSH_INTERVAL est écoulé,
+    // passe les pages sales au thread de fond (copie mémoire seulement)
+    void endFrame();
+
+private:
+    std::string path;
+    uint8_t* ram = nullptr;
+    size_t ramSize = 0;
+
+    // Pages du système (granularité de msync)
+    size_t pageShift = 12;
+    std::unique_ptr<std::atomic<uint64_t>[]> dirty;
+    size_t dirtyWords = 0;
+
+#ifdef _WIN32
+    std::vector<uint8_t> buffer;
+    std::fstream file;  // Utilisé par le thread de fond seul, puis par close()
+#else
+    int fd = -1;
+#endif
+
+    // Pages sales consécutives à écrire ; bytes : copie faite en fin de frame
+    // (Windows), vide avec mmap
+    struct PendingWrite {
+        size_t offset;
+        size_t length;
+        std::vector<uint8_t> bytes;
+    };
+
+    std::thread flusher;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<PendingWrite> staged;  // Protégé par mutex
+    bool stopping = false;
+    std::chrono::steady_clock::time_point lastFlush;
+
+    void flushLoop();
+    std::vector<PendingWrite> collectDirtyPages();
+    void writePages(const PendingWrite& pages);
+};
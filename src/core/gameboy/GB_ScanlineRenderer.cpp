@@ -0,0 +1,190 @@
+#include "core/gameboy/GB_ScanlineRenderer.h"
+#include "core/gameboy/GB_MMU.h"
+
+#include <algorithm>
+#include <cstring>
+
+using RasterReg = GB_PPUState::RasterReg;
+using Mode = GB_PPUState::Mode;
+
+GB_ScanlineRenderer::GB_ScanlineRenderer(GB_PPUState& ppuState) : state(ppuState) {
+    // VRAM modifiée pendant l'affichage : les lignes déjà dues sont
+    // dessinées avant que l'écriture ne prenne effet
+    state.mmu.setVideoWriteHandler(
+        [](void* ctx) {
+            auto* renderer = static_cast<GB_ScanlineRenderer*>(ctx);
+            renderer->renderPendingLines(renderer->completedLines());
+        },
+        this);
+}
+
+void GB_ScanlineRenderer::reset() {
+    frameActive = false;
+    rasterLog.clear();
+    rasterLogPos = 0;
+    renderedLines = 0;
+    state.mmu.setVideoWriteTrap(false);
+}
+
+void GB_ScanlineRenderer::endDrawing() {
+    if (!frameActive) renderScanline(state.currentScanline, state.readRasterRegisters());
+}
+
+void GB_ScanlineRenderer::setDeferredRendering(bool enabled) {
+    if (enabled == deferredRendering) return;
+
+    // Un passage en rendu ligne à ligne termine d'abord les lignes en attente ;
+    // l'activation ne prend effet qu'à la frame suivante
+    if (!enabled) endFrame();
+    deferredRendering = enabled;
+}
+
+void GB_ScanlineRenderer::rasterWrite(RasterReg reg, uint8_t value) {
+    if (frameActive) {
+        rasterLog.push_back({static_cast<uint8_t>(completedLines()), reg, value});
+    }
+}
+
+void GB_ScanlineRenderer::beginFrame() {
+    renderedLines = 0;
+    rasterLog.clear();
+    rasterLogPos = 0;
+
+    frameActive = deferredRendering;
+    if (frameActive) {
+        frameRegisters = state.readRasterRegisters();
+    }
+    state.mmu.setVideoWriteTrap(frameActive);
+}
+
+void GB_ScanlineRenderer::endFrame() {
+    if (!frameActive) return;
+
+    renderPendingLines(completedLines());
+    frameActive = false;
+    state.mmu.setVideoWriteTrap(false);
+}
+
+int GB_ScanlineRenderer::completedLines() const {
+    // Une ligne est dessinée à la fin de son mode 3. LY passe à 144 avant
+    // l'entrée en VBlank : le compte est borné aux lignes visibles
+    if (state.mode == Mode::VBlank) return 144;
+    return std::min(state.currentScanline + (state.mode == Mode::HBlank ? 1 : 0), 144);
+}
+
+void GB_ScanlineRenderer::renderPendingLines(int upTo) {
+    if (!frameActive) return;
+
+    while (renderedLines < upTo) {
+        while (rasterLogPos < rasterLog.size() && rasterLog[rasterLogPos].line <= renderedLines) {
+            const RasterWrite& entry = rasterLog[rasterLogPos++];
+            frameRegisters[entry.reg] = entry.value;
+        }
+
+        renderScanline(static_cast<uint8_t>(renderedLines++), frameRegisters);
+    }
+}
+
+void GB_ScanlineRenderer::renderScanline(uint8_t ly, const RasterRegisters& regs) {
+    uint8_t lcdc = regs[GB_PPUState::LCDC];
+
+    state.updateTileCache();
+
+    std::array<uint8_t, LINE_BUFFER_SIZE> line;
+    uint8_t* pixels;
+    uint8_t palette;
+
+    if (lcdc & 0x01) {
+        pixels = renderBackground(ly, regs, line);
+        renderWindow(ly, regs, pixels);
+        palette = regs[GB_PPUState::BGP];
+    } else {
+        // BG et fenêtre désactivés : ligne blanche, les sprites restent affichés
+        line.fill(0);
+        pixels = line.data();
+        palette = 0x00;
+    }
+
+    uint8_t* rgba = state.lineRGBA(ly);
+    state.compositor.compose(pixels, palette, rgba);
+
+    if (lcdc & 0x02) {
+        renderSprites(ly, regs, pixels, rgba);
+    }
+}
+
+void GB_ScanlineRenderer::fetchTileRow(uint16_t mapBase, uint8_t lcdc, uint8_t tileRow,
+                                       uint8_t pixelY, uint8_t firstCol, uint8_t* out) const {
+    const uint8_t* tileMap = state.vram() + (mapBase - 0x8000) + tileRow * 32;
+
+    // 21 tuiles couvrent les 160 pixels quel que soit le décalage fin
+    for (int i = 0; i < 21; i++) {
+        uint16_t tile = GB_PPUState::bgTile(lcdc, tileMap[(firstCol + i) & 31]);
+        std::memcpy(out + i * 8, state.tileCache.getRow(tile, pixelY), 8);
+    }
+}
+
+uint8_t* GB_ScanlineRenderer::renderBackground(uint8_t ly, const RasterRegisters& regs,
+                                               std::array<uint8_t, LINE_BUFFER_SIZE>& line) {
+    uint8_t scrollY = regs[GB_PPUState::SCY];
+    uint8_t scrollX = regs[GB_PPUState::SCX];
+
+    uint8_t lcdc = regs[GB_PPUState::LCDC];
+    uint16_t tileMapBase = (lcdc & 0x08) ? 0x9C00 : 0x9800;
+
+    uint8_t y = ly + scrollY;
+    fetchTileRow(tileMapBase, lcdc, y / 8, y % 8, scrollX / 8, line.data());
+
+    return line.data() + (scrollX % 8);
+}
+
+void GB_ScanlineRenderer::renderWindow(uint8_t ly, const RasterRegisters& regs, uint8_t* pixels) {
+    uint8_t lcdc = regs[GB_PPUState::LCDC];
+    if ((lcdc & 0x20) == 0) return;
+
+    int wx = GB_PPUState::windowX(regs[GB_PPUState::WX]);
+    if (ly < regs[GB_PPUState::WY] || wx >= 160) return;
+
+    uint16_t tileMapBase = (lcdc & 0x40) ? 0x9C00 : 0x9800;
+
+    std::array<uint8_t, LINE_BUFFER_SIZE> window;
+    fetchTileRow(tileMapBase, lcdc, state.windowLine / 8, state.windowLine % 8, 0, window.data());
+
+    int start = wx < 0 ? 0 : wx;
+    std::memcpy(pixels + start, window.data() + (start - wx), 160 - start);
+    state.windowLine++;
+}
+
+void GB_ScanlineRenderer::renderSprites(uint8_t ly, const RasterRegisters& regs,
+                                        const uint8_t* bgPixels, uint8_t* rgba) {
+    int height = (regs[GB_PPUState::LCDC] & 0x04) ? 16 : 8;
+    const uint8_t palettes[2] = { regs[GB_PPUState::OBP0], regs[GB_PPUState::OBP1] };
+
+    // Un pixel revient au premier sprite opaque dans l'ordre de priorité, même
+    // si c'est le fond qui finit affiché (bit 7 : derrière les couleurs 1-3 du fond)
+    std::array<bool, 160> claimed{};
+
+    const GB_PPUState::LineSprites& selected = state.lineSprites[ly];
+    for (int i = 0; i < selected.count; i++) {
+        const GB_PPUState::Sprite& sprite = selected.sprites[i];
+        const uint8_t* colors = state.spriteRow(sprite, ly, height);
+
+        bool flipX = (sprite.flags & 0x20) != 0;
+        bool behindBG = (sprite.flags & 0x80) != 0;
+        uint8_t palette = palettes[(sprite.flags >> 4) & 1];
+
+        int left = sprite.x - 8;
+        for (int px = 0; px < 8; px++) {
+            int x = left + px;
+            if (x < 0 || x >= 160 || claimed[x]) continue;
+
+            uint8_t color = colors[flipX ? 7 - px : px];
+            if (color == 0) continue;  // Transparent
+
+            claimed[x] = true;
+            if (behindBG && bgPixels[x] != 0) continue;
+
+            state.compositor.composePixel(color, palette, rgba + x * 4);
+        }
+    }
+}
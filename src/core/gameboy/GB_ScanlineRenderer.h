@@ -0,0 +1,65 @@
+#pragma once
+#include "core/gameboy/GB_PPU.h"
+#include <vector>
+
+// Renderer rapide : une ligne entière d'un coup à la fin de son mode 3, dont
+// la durée est fixe. Les écritures de registres en milieu de ligne ne prennent
+// effet qu'à la ligne suivante.
+class GB_ScanlineRenderer {
+public:
+    static constexpr const char* NAME = "Scanline";
+    static constexpr bool VARIABLE_DRAWING = false;
+    static constexpr int DRAWING_CYCLES = 172;
+
+    using RasterReg = GB_PPUState::RasterReg;
+    using RasterRegisters = GB_PPUState::RasterRegisters;
+
+    explicit GB_ScanlineRenderer(GB_PPUState& state);
+
+    void reset();
+    void beginFrame();
+    void endFrame();
+
+    int beginDrawing() { return DRAWING_CYCLES; }
+    void endDrawing();
+
+    void rasterWrite(RasterReg reg, uint8_t value);
+
+    // Rendu différé : les lignes visibles sont dessinées d'un bloc à l'entrée du
+    // VBlank, d'après le journal des écritures de registres de la frame
+    void setDeferredRendering(bool enabled);
+    bool isDeferredRendering() const { return deferredRendering; }
+
+private:
+    GB_PPUState& state;
+
+    // Journal de la frame en cours : une écriture s'applique à partir de la
+    // première ligne pas encore dessinée au moment où elle a lieu
+    struct RasterWrite {
+        uint8_t line;
+        RasterReg reg;
+        uint8_t value;
+    };
+
+    bool deferredRendering = true;
+    bool frameActive = false;        // Lignes visibles en attente de rendu
+    RasterRegisters frameRegisters{};  // Valeurs au début de la frame, puis avancées par le journal
+    std::vector<RasterWrite> rasterLog;
+    size_t rasterLogPos = 0;
+    int renderedLines = 0;
+
+    int completedLines() const;
+    void renderPendingLines(int upTo);
+
+    // Rendering : la ligne est d'abord construite en indices de couleur
+    // (fond puis fenêtre), convertie d'un bloc par le compositeur, puis les
+    // pixels des sprites retenus sont posés par-dessus
+    static constexpr int LINE_BUFFER_SIZE = 21 * 8;  // 160 pixels + décalage fin de SCX
+
+    void renderScanline(uint8_t ly, const RasterRegisters& regs);
+    uint8_t* renderBackground(uint8_t ly, const RasterRegisters& regs, std::array<uint8_t, LINE_BUFFER_SIZE>& line);
+    void renderWindow(uint8_t ly, const RasterRegisters& regs, uint8_t* pixels);
+    void renderSprites(uint8_t ly, const RasterRegisters& regs, const uint8_t* bgPixels, uint8_t* rgba);
+    void fetchTileRow(uint16_t mapBase, uint8_t lcdc, uint8_t tileRow, uint8_t pixelY,
+                      uint8_t firstCol, uint8_t* out) const;
+};
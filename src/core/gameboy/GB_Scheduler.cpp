@@ -0,0 +1,104 @@
+#include "core/gameboy/GB_Scheduler.h"
+#include "utils/Logger.h"
+
+GB_Scheduler::GB_Scheduler() {
+    reset();
+}
+
+void GB_Scheduler::reset() {
+    timestamp = 0;
+    nextEvent = NEVER;
+    heapSize = 0;
+    position.fill(-1);
+
+    LOG_DEBUG("GB Scheduler reset");
+}
+
+void GB_Scheduler::setHandler(GB_Event event, Handler handler) {
+    handlers[index(event)] = std::move(handler);
+}
+
+void GB_Scheduler::schedule(GB_Event event, uint64_t when) {
+    int pos = position[index(event)];
+
+    if (pos >= 0) {
+        // Déjà planifié : on déplace l'entrée
+        uint64_t old = heap[pos].when;
+        heap[pos].when = when;
+        if (when < old) siftUp(pos);
+        else siftDown(pos);
+    } else {
+        size_t i = heapSize++;
+        heap[i] = {when, event};
+        position[index(event)] = static_cast<int>(i);
+        siftUp(i);
+    }
+
+    nextEvent = heap[0].when;
+}
+
+void GB_Scheduler::cancel(GB_Event event) {
+    int pos = position[index(event)];
+    if (pos < 0) return;
+
+    removeAt(pos);
+    nextEvent = heapSize ? heap[0].when : NEVER;
+}
+
+void GB_Scheduler::runEvents() {
+    // Un handler peut se replanifier (ou en planifier d'autres) pendant la boucle
+    while (heapSize && heap[0].when <= timestamp) {
+        Entry entry = heap[0];
+        removeAt(0);
+        nextEvent = heapSize ? heap[0].when : NEVER;
+
+        Handler& handler = handlers[index(entry.event)];
+        if (handler) {
+            handler(entry.when);
+        }
+    }
+
+    nextEvent = heapSize ? heap[0].when : NEVER;
+}
+
+void GB_Scheduler::removeAt(size_t i) {
+    position[index(heap[i].event)] = -1;
+
+    size_t last = --heapSize;
+    if (i == last) return;
+
+    heap[i] = heap[last];
+    position[index(heap[i].event)] = static_cast<int>(i);
+    siftUp(i);
+    siftDown(i);
+}
+
+void GB_Scheduler::siftUp(size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (heap[parent].when <= heap[i].when) break;
+        swapEntries(i, parent);
+        i = parent;
+    }
+}
+
+void GB_Scheduler::siftDown(size_t i) {
+    while (true) {
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        size_t smallest = i;
+
+        if (left < heapSize && heap[left].when < heap[smallest].when) smallest = left;
+        if (right < heapSize && heap[right].when < heap[smallest].when) smallest = right;
+        if (smallest == i) break;
+
+        swapEntries(i, smallest);
+        i = smallest;
+    }
+}
+
+void GB_Scheduler::swapEntries(size_t i, size_t j) {
+    std::swap(heap[i], heap[j]);
+    position[index(heap[i].event)] = static_cast<int>(i);
+    position[index(heap[j].event)] = static_cast<int>(j);
+}
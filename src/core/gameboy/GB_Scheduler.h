@@ -0,0 +1,74 @@
+#pragma once
+#include "common/types.h"
+#include <array>
+#include <functional>
+
+// Événements planifiés sur l'horloge maître
+enum class GB_Event : uint8_t {
+    PPU = 0,    // Changement de mode PPU (OAM Scan / Drawing / HBlank / VBlank)
+    Timer,      // Prochain débordement de TIMA
+    DMA,        // Fin de la fenêtre OAM DMA (le CPU retrouve tout le bus)
+    Serial,     // Fin d'un transfert série en horloge interne
+    Joypad,     // Prochain changement de bouton horodaté par l'hôte
+    Count
+};
+
+// Horloge maître 64 bits + min-heap des prochains événements.
+// Les sous-systèmes ne tournent plus à chaque addCycles : ils planifient leur
+// prochain changement d'état et rattrapent le temps écoulé quand il arrive.
+class GB_Scheduler {
+#ifdef GB_JIT_ENABLED
+    // Le code natif chaîné avance l'horloge lui-même, sans atteindre nextEvent
+    friend class GB_Jit;
+#endif
+public:
+    // when = cycle auquel l'événement était planifié (<= now())
+    using Handler = std::function<void(uint64_t when)>;
+
+    static constexpr uint64_t NEVER = ~0ULL;
+
+    GB_Scheduler();
+
+    void reset();
+
+    uint64_t now() const { return timestamp; }
+    uint64_t nextEventTime() const { return nextEvent; }
+
+    void setHandler(GB_Event event, Handler handler);
+
+    void schedule(GB_Event event, uint64_t when);
+    void scheduleIn(GB_Event event, uint64_t delay) { schedule(event, timestamp + delay); }
+    void cancel(GB_Event event);
+    bool isScheduled(GB_Event event) const { return position[index(event)] >= 0; }
+
+    inline void advance(int cycles) {
+        timestamp += cycles;
+        if (timestamp >= nextEvent) {
+            runEvents();
+        }
+    }
+
+private:
+    struct Entry {
+        uint64_t when;
+        GB_Event event;
+    };
+
+    static constexpr size_t EVENT_COUNT = static_cast<size_t>(GB_Event::Count);
+    static size_t index(GB_Event event) { return static_cast<size_t>(event); }
+
+    uint64_t timestamp = 0;
+    uint64_t nextEvent = NEVER;
+
+    std::array<Entry, EVENT_COUNT> heap{};
+    std::array<int, EVENT_COUNT> position{};  // Index dans le heap, -1 si non planifié
+    size_t heapSize = 0;
+
+    std::array<Handler, EVENT_COUNT> handlers{};
+
+    void runEvents();
+    void removeAt(size_t i);
+    void siftUp(size_t i);
+    void siftDown(size_t i);
+    void swapEntries(size_t i, size_t j);
+};
@@ -0,0 +1,71 @@
+#include "core/gameboy/GB_Serial.h"
+#include "core/gameboy/GB_MMU.h"
+#include "core/gameboy/GB_Scheduler.h"
+#include "core/gameboy/GB_Interrupts.h"
+#include "utils/Logger.h"
+
+uint8_t GB_SerialStdout::exchange(uint8_t out) {
+    buffer += static_cast<char>(out);
+    if (out == '\n') flush();
+    return 0xFF;
+}
+
+void GB_SerialStdout::flush() {
+    if (buffer.empty()) return;
+    std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+    std::fflush(stdout);
+    buffer.clear();
+}
+
+uint8_t GB_SerialPeer::exchange(uint8_t out) {
+    return peer.receiveExternal(out);
+}
+
+GB_Serial::GB_Serial(GB_MMU& mem, GB_Scheduler& sched, GB_Interrupts& irq)
+    : mmu(mem), scheduler(sched), interrupts(irq), sink(std::make_unique<GB_SerialStdout>()) {
+    scheduler.setHandler(GB_Event::Serial, [this](uint64_t) {
+        uint8_t out = mmu.read(0xFF01);
+        completeTransfer(sink ? sink->exchange(out) : 0xFF);
+    });
+
+    // SB reste dans la mémoire de fond, SC lance le transfert
+    mmu.mapIO(0xFF02, nullptr,
+        [](void* ctx, uint16_t, uint8_t data) { static_cast<GB_Serial*>(ctx)->writeSC(data); },
+        this);
+
+    reset();
+}
+
+void GB_Serial::reset() {
+    scheduler.cancel(GB_Event::Serial);
+    LOG_DEBUG("GB Serial reset");
+}
+
+void GB_Serial::writeSC(uint8_t data) {
+    mmu.directWrite(0xFF02, data);
+
+    // Bit 7 : transfert demandé, bit 0 : horloge interne. En horloge externe,
+    // c'est l'autre console qui termine le transfert (receiveExternal)
+    if ((data & 0x81) == 0x81) {
+        scheduler.scheduleIn(GB_Event::Serial, TRANSFER_CYCLES);
+    } else {
+        scheduler.cancel(GB_Event::Serial);
+    }
+}
+
+uint8_t GB_Serial::receiveExternal(uint8_t in) {
+    uint8_t out = mmu.read(0xFF01);
+
+    // Sans transfert en attente, l'octet est perdu : SB n'est pas décalé
+    uint8_t sc = mmu.read(0xFF02);
+    if ((sc & 0x81) != 0x80) return 0xFF;
+
+    completeTransfer(in);
+    return out;
+}
+
+void GB_Serial::completeTransfer(uint8_t in) {
+    mmu.directWrite(0xFF01, in);
+    mmu.directWrite(0xFF02, mmu.read(0xFF02) & 0x7F);
+    interrupts.request(GB_Interrupts::SERIAL);
+}
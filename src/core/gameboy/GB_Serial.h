@@ -0,0 +1,83 @@
+#pragma once
+#include "common/types.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+
+class GB_MMU;
+class GB_Scheduler;
+class GB_Interrupts;
+class GB_Serial;
+
+// Destination des octets envoyés sur le port série. exchange() reçoit l'octet
+// sorti de SB et renvoie celui qui rentre (0xFF : pas de câble branché).
+class GB_SerialSink {
+public:
+    virtual ~GB_SerialSink() = default;
+    virtual uint8_t exchange(uint8_t out) = 0;
+};
+
+// Sortie console bufferisée : vidée à chaque fin de ligne et à la destruction
+class GB_SerialStdout : public GB_SerialSink {
+public:
+    ~GB_SerialStdout() override { flush(); }
+    uint8_t exchange(uint8_t out) override;
+    void flush();
+
+private:
+    std::string buffer;
+};
+
+// Capture en mémoire (harness de test : sorties des ROMs de test blargg/mooneye)
+class GB_SerialCapture : public GB_SerialSink {
+public:
+    uint8_t exchange(uint8_t out) override {
+        output += static_cast<char>(out);
+        return 0xFF;
+    }
+    const std::string& getOutput() const { return output; }
+    void clear() { output.clear(); }
+
+private:
+    std::string output;
+};
+
+// Câble link vers une autre instance : l'octet sortant remplace le SB de
+// l'autre console, qui termine son transfert en horloge externe
+class GB_SerialPeer : public GB_SerialSink {
+public:
+    explicit GB_SerialPeer(GB_Serial& peer) : peer(peer) {}
+    uint8_t exchange(uint8_t out) override;
+
+private:
+    GB_Serial& peer;
+};
+
+// Port série (SB 0xFF01, SC 0xFF02). Un transfert lancé en horloge interne se
+// termine d'un bloc sur un événement planifié 8 bits plus tard : pas de
+// scrutation à chaque instruction.
+class GB_Serial {
+public:
+    static constexpr uint64_t TRANSFER_CYCLES = 8 * 512;  // 8 bits à 8192 Hz
+
+    GB_Serial(GB_MMU& mmu, GB_Scheduler& scheduler, GB_Interrupts& interrupts);
+
+    void reset();
+
+    // nullptr : pas de câble, les octets reçus valent 0xFF
+    void setSink(std::unique_ptr<GB_SerialSink> newSink) { sink = std::move(newSink); }
+    GB_SerialSink* getSink() const { return sink.get(); }
+
+    // Appelé par la console qui fournit l'horloge (GB_SerialPeer)
+    uint8_t receiveExternal(uint8_t in);
+
+private:
+    GB_MMU& mmu;
+    GB_Scheduler& scheduler;
+    GB_Interrupts& interrupts;
+
+    std::unique_ptr<GB_SerialSink> sink;
+
+    void writeSC(uint8_t data);
+    void completeTransfer(uint8_t in);
+};
@@ -0,0 +1,52 @@
+#include "core/gameboy/GB_TileCache.h"
+
+#include <cstring>
+
+namespace {
+
+// Octet d'un plan de bits -> 8 octets valant 0 ou 1, pixel 0 (bit 7) en tête.
+// Chaque octet reste à 0/1 : décaler le mot entier d'un bit ne déborde jamais
+// sur le pixel voisin, quel que soit l'ordre des octets de l'hôte.
+struct ExpandTable {
+    uint64_t rows[256];
+
+    ExpandTable() {
+        for (int value = 0; value < 256; ++value) {
+            uint8_t bytes[8];
+            for (int x = 0; x < 8; ++x) {
+                bytes[x] = (value >> (7 - x)) & 1;
+            }
+            std::memcpy(&rows[value], bytes, 8);
+        }
+    }
+};
+
+const ExpandTable expand;
+
+}  // namespace
+
+void GB_TileCache::update(const uint8_t* vram, const DirtyBitmap& dirty) {
+    for (size_t word = 0; word < DIRTY_WORDS; ++word) {
+        uint64_t bits = dirty[word];
+        for (size_t bit = 0; bits != 0; ++bit, bits >>= 1) {
+            if (bits & 1) decodeTile(vram, word * 64 + bit);
+        }
+    }
+}
+
+void GB_TileCache::decodeAll(const uint8_t* vram) {
+    for (size_t tile = 0; tile < TILE_COUNT; ++tile) {
+        decodeTile(vram, tile);
+    }
+}
+
+void GB_TileCache::decodeTile(const uint8_t* vram, size_t tile) {
+    // 2 octets par ligne : bit bas puis bit haut de chaque pixel, pixel 0 = bit 7
+    const uint8_t* data = vram + tile * 16;
+    uint8_t* out = tiles[tile].data();
+
+    for (int y = 0; y < 8; ++y) {
+        uint64_t row = expand.rows[data[y * 2]] | (expand.rows[data[y * 2 + 1]] << 1);
+        std::memcpy(out + y * 8, &row, 8);
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "common/types.h"
+#include <array>
+#include <cstddef>
+
+// Les 384 tuiles de la VRAM (0x8000-0x97FF) décodées en indices de couleur 8x8.
+// Le MMU marque les tuiles écrites dans un bitmap ; update() ne redécode que
+// celles-ci, le rendu d'une ligne n'est plus qu'une suite de copies de 8 octets.
+class GB_TileCache {
+public:
+    static constexpr size_t TILE_COUNT = 384;
+    static constexpr size_t DIRTY_WORDS = (TILE_COUNT + 63) / 64;
+
+    using DirtyBitmap = std::array<uint64_t, DIRTY_WORDS>;
+
+    // vram pointe sur 0x8000
+    void update(const uint8_t* vram, const DirtyBitmap& dirty);
+    void decodeAll(const uint8_t* vram);
+
+    // 8 indices de couleur (0-3) de la ligne y de la tuile
+    const uint8_t* getRow(uint16_t tile, uint8_t y) const { return tiles[tile].data() + y * 8; }
+
+private:
+    std::array<std::array<uint8_t, 64>, TILE_COUNT> tiles{};
+
+    void decodeTile(const uint8_t* vram, size_t tile);
+};
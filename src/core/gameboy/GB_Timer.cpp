@@ -1,25 +1,103 @@
 #include "core/gameboy/GB_Timer.h"
 #include "core/gameboy/GB_MMU.h"
+#include "core/gameboy/GB_Scheduler.h"
+#include "core/gameboy/GB_Interrupts.h"
+
+GB_Timer::GB_Timer(GB_MMU& mem, GB_Scheduler& sched, GB_Interrupts& irq)
+    : mmu(mem), scheduler(sched), interrupts(irq) {
+    scheduler.setHandler(GB_Event::Timer, [this](uint64_t) {
+        sync();
+        scheduleOverflow();
+    });
+
+    // DIV : lu depuis le compteur interne, toute écriture le remet à 0
+    mmu.mapIO(0xFF04,
+        [](void* ctx, uint16_t) { return static_cast<GB_Timer*>(ctx)->getDIV(); },
+        [](void* ctx, uint16_t, uint8_t) { static_cast<GB_Timer*>(ctx)->resetDIV(); },
+        this);
+
+    // TIMA : rattrapé à la lecture, la mémoire de fond n'est à jour qu'aux synchros
+    mmu.mapIO(0xFF05,
+        [](void* ctx, uint16_t) { return static_cast<GB_Timer*>(ctx)->readTIMA(); },
+        [](void* ctx, uint16_t, uint8_t data) { static_cast<GB_Timer*>(ctx)->writeTIMA(data); },
+        this);
+
+    mmu.mapIO(0xFF06, nullptr,
+        [](void* ctx, uint16_t, uint8_t data) { static_cast<GB_Timer*>(ctx)->writeTMA(data); },
+        this);
+
+    mmu.mapIO(0xFF07, nullptr,
+        [](void* ctx, uint16_t, uint8_t data) { static_cast<GB_Timer*>(ctx)->writeTAC(data); },
+        this);
 
-GB_Timer::GB_Timer(GB_MMU& mem) : mmu(mem) {
     reset();
 }
 
 void GB_Timer::reset() {
-    internalCounter = 0;
-    prevInternalCounter = 0;
+    // TIMA/TMA/TAC repris de la mémoire, déjà initialisée par le MMU
+    const uint8_t* memory = mmu.getMemoryPtr();
+    tima = memory[0xFF05];
+    tma = memory[0xFF06];
+    tac = memory[0xFF07];
+
+    divBase = scheduler.now();
+    lastSync = divBase;
+    scheduleOverflow();
+}
+
+uint16_t GB_Timer::currentCounter() const {
+    return counterAt(scheduler.now());
+}
+
+void GB_Timer::sync() {
+    uint64_t now = scheduler.now();
+
+    if (isEnabled()) {
+        // Un front descendant du bit sélectionné à chaque passage d'un multiple
+        // de 2^(bit+1) : on compte tous ceux traversés depuis la dernière synchro
+        int shift = getMultiplierBit() + 1;
+        uint64_t edges = ((now - divBase) >> shift) - ((lastSync - divBase) >> shift);
+
+        // lastSync mis à jour avant le rattrapage : un sync() réentrant ne
+        // compte pas une seconde fois le même intervalle
+        lastSync = now;
+        advanceTIMA(edges);
+    } else {
+        lastSync = now;
+    }
+}
+
+uint8_t GB_Timer::readTIMA() {
+    sync();
+    return tima;
+}
+
+void GB_Timer::writeTIMA(uint8_t value) {
+    sync();
+    tima = value;
+    mmu.directWrite(0xFF05, value);
+    scheduleOverflow();
+}
+
+void GB_Timer::writeTMA(uint8_t value) {
+    // Un débordement déjà passé recharge l'ancienne valeur
+    sync();
+    tma = value;
+    mmu.directWrite(0xFF06, value);
 }
 
 void GB_Timer::resetDIV() {
-    // ⚡ Quand DIV est reset, check TIMA avant
-    updateTIMA();
-    prevInternalCounter = internalCounter;
-    internalCounter = 0;
+    sync();
+
+    // ⚡ Quand DIV est reset, le bit sélectionné peut passer de 1 à 0 → TIMA++
+    if (getTimerBit()) {
+        incrementTIMA();
+    }
+    divBase = scheduler.now();
+    scheduleOverflow();
 }
 
 int GB_Timer::getMultiplierBit() const {
-    uint8_t tac = mmu.read(0xFF07);
-
     // ⚡ Bits à checker selon TAC
     switch (tac & 0x03) {
     case 0: return 9;   // 1024 cycles (bit 9)
@@ -31,82 +109,56 @@ int GB_Timer::getMultiplierBit() const {
 }
 
 bool GB_Timer::getTimerBit() const {
-    uint8_t tac = mmu.read(0xFF07);
-
     // Timer désactivé → bit = 0
-    if ((tac & 0x04) == 0) return false;
+    if (!isEnabled()) return false;
 
     int bit = getMultiplierBit();
-    return (internalCounter & (1 << bit)) != 0;
+    return (currentCounter() & (1 << bit)) != 0;
 }
 
 void GB_Timer::writeTAC(uint8_t value) {
-    uint8_t oldTAC = mmu.read(0xFF07);
-
-    bool oldEnabled = (oldTAC & 0x04) != 0;
-    bool newEnabled = (value & 0x04) != 0;
+    sync();
 
     // ⚡ Si le timer était activé, check falling edge
-    if (oldEnabled) {
-        bool oldBit = getTimerBit();
+    bool oldBit = getTimerBit();
 
-        // Écrit la nouvelle valeur
-        mmu.directWriteTAC(value);
+    tac = value;
+    mmu.directWriteTAC(value);
 
-        bool newBit = getTimerBit();
-
-        // Falling edge → Incrémente TIMA
-        if (oldBit && !newBit) {
-            uint8_t tima = mmu.read(0xFF05);
-
-            if (tima == 0xFF) {
-                uint8_t tma = mmu.read(0xFF06);
-                mmu.write(0xFF05, tma);
-
-                uint8_t IF = mmu.read(0xFF0F);
-                mmu.write(0xFF0F, IF | 0x04);
-            } else {
-                mmu.write(0xFF05, tima + 1);
-            }
-        }
-    } else {
-        // Timer était désactivé, juste écrire
-        mmu.directWriteTAC(value);
+    // Falling edge → Incrémente TIMA
+    if (oldBit && !getTimerBit()) {
+        incrementTIMA();
     }
-}
-
-void GB_Timer::updateTIMA() {
-    uint8_t tac = mmu.read(0xFF07);
-
-    if ((tac & 0x04) == 0) return;
-
-    int bit = getMultiplierBit();
-
-    bool prevBit = (prevInternalCounter & (1 << bit)) != 0;
-    bool newBit = (internalCounter & (1 << bit)) != 0;
-
-    if (prevBit && !newBit) {
-        uint8_t tima = mmu.read(0xFF05);
 
-        if (tima == 0xFF) {
-            uint8_t tma = mmu.read(0xFF06);
-            mmu.write(0xFF05, tma);
+    scheduleOverflow();
+}
 
-            uint8_t IF = mmu.read(0xFF0F);
-            mmu.write(0xFF0F, IF | 0x04);
-        } else {
-            mmu.write(0xFF05, tima + 1);
+void GB_Timer::advanceTIMA(uint64_t edges) {
+    // Chaque débordement recharge TMA et lève l'interruption ; le reste des
+    // fronts s'ajoute d'un coup
+    while (edges > 0) {
+        uint32_t untilOverflow = 0x100 - tima;
+        if (edges < untilOverflow) {
+            tima = static_cast<uint8_t>(tima + edges);
+            break;
         }
+
+        edges -= untilOverflow;
+        tima = tma;
+        interrupts.request(GB_Interrupts::TIMER);
     }
-}
 
-void GB_Timer::step(int cycles) {
-    // Sauvegarde l'ancien compteur
-    prevInternalCounter = internalCounter;
+    mmu.directWrite(0xFF05, tima);
+}
 
-    // Incrémente le compteur interne
-    internalCounter += cycles;
+void GB_Timer::scheduleOverflow() {
+    if (!isEnabled()) {
+        scheduler.cancel(GB_Event::Timer);
+        return;
+    }
 
-    // Update TIMA basé sur les falling edges
-    updateTIMA();
-}
\ No newline at end of file
+    // Le débordement tombe sur le (0x100 - TIMA)-ième front après la dernière synchro
+    int shift = getMultiplierBit() + 1;
+    uint64_t edgeIndex = ((lastSync - divBase) >> shift) + (0x100 - tima);
+    scheduler.schedule(GB_Event::Timer, divBase + (edgeIndex << shift));
+}
@@ -2,29 +2,55 @@
 #include "common/Types.h"
 
 class GB_MMU;
+class GB_Scheduler;
+class GB_Interrupts;
 
+// Timer (DIV/TIMA/TMA/TAC) calculé plutôt qu'incrémenté : DIV est déduit d'un
+// instant de base, et TIMA n'est rattrapé que lorsqu'un de ses registres est
+// accédé ou lorsque survient le débordement, dont l'instant exact est prédit
+// et planifié d'avance.
 class GB_Timer {
 public:
-    GB_Timer(GB_MMU& mmu);
+    GB_Timer(GB_MMU& mmu, GB_Scheduler& scheduler, GB_Interrupts& interrupts);
 
     void reset();
-    void step(int cycles);
+
+    // Rattrape les fronts écoulés depuis la dernière synchro (appelé par les
+    // handlers I/O de DIV/TIMA/TMA/TAC, et au débordement planifié)
+    void sync();
 
     uint8_t getDIV() const {
-        return (internalCounter >> 8) & 0xFF;
+        return (currentCounter() >> 8) & 0xFF;
     }
+    uint8_t readTIMA();
 
     void resetDIV();
+    void writeTIMA(uint8_t value);
+    void writeTMA(uint8_t value);
     void writeTAC(uint8_t value);
 
 private:
     GB_MMU& mmu;
+    GB_Scheduler& scheduler;
+    GB_Interrupts& interrupts;
 
-    uint16_t internalCounter = 0;
-    uint16_t prevInternalCounter = 0;
+    // Compteur interne 16 bits = instant courant - divBase
+    uint64_t divBase = 0;
+    uint64_t lastSync = 0;   // Fronts comptés jusqu'à cet instant
 
-    bool getTimerBit() const;
+    // Registres tenus par le timer, recopiés en mémoire à chaque synchro
+    uint8_t tima = 0;
+    uint8_t tma = 0;
+    uint8_t tac = 0;
+
+    uint16_t counterAt(uint64_t time) const { return static_cast<uint16_t>(time - divBase); }
+    uint16_t currentCounter() const;
 
-    void updateTIMA();
+    bool isEnabled() const { return (tac & 0x04) != 0; }
     int getMultiplierBit() const;
-};
\ No newline at end of file
+    bool getTimerBit() const;
+
+    void advanceTIMA(uint64_t edges);
+    void incrementTIMA() { advanceTIMA(1); }
+    void scheduleOverflow();
+};
@@ -6,10 +6,17 @@
 #include "utils/Logger.h"
 #include "config/EmulatorConfig.h"
 
-Gameboy::Gameboy() : cpu(memory,ppu,timer), ppu(memory), joypad(memory), timer(memory) {
-    memory.setTimer(&timer);
+#include <algorithm>
+
+Gameboy::Gameboy(GB_PPUModel ppuModel)
+    : memory(scheduler, interrupts),
+      cpu(memory, scheduler, interrupts),
+      ppu(GB_PPU::create(ppuModel, memory, scheduler, interrupts)),
+      joypad(memory, scheduler, interrupts),
+      timer(memory, scheduler, interrupts),
+      serial(memory, scheduler, interrupts) {
     framebuffer.fill(0xFF);  // Blanc par défaut
-    LOG_DEBUG("Game Boy emulator created");
+    LOG_DEBUG("Game Boy emulator created (PPU: {})", ppu->getName());
 }
 
 bool Gameboy::loadROM(const std::string& path) {
@@ -33,10 +40,16 @@ bool Gameboy::loadROM(const std::string& path) {
 }
 
 void Gameboy::reset() {
+    memory.prepareReset();
+    scheduler.reset();
+    interrupts.reset();
+    memory.resetMapper();
     cpu.reset();
-    ppu.reset();
+    ppu->reset();
     joypad.reset();
     timer.reset();
+    serial.reset();
+    frameEnd = scheduler.now();
     framebuffer.fill(0xFF);
     LOG_DEBUG("Game Boy emulator reset");
 }
@@ -50,15 +63,15 @@ void Gameboy::runFrame() {
 
     cpu.resetCycles();
 
-    while (cpu.getCycles() < Config::GB_CYCLES_PER_FRAME) {
-        cpu.step();
-    }
-
-    joypad.update();
+    // Frame bornée sur l'horloge maître : un saut de HALT qui dépasse la fin
+    // de frame est simplement décompté de la suivante
+    frameEnd += Config::GB_CYCLES_PER_FRAME;
+    cpu.run(frameEnd);
+    memory.endFrame();
 
-    if (ppu.isFrameReady()) {
-        std::memcpy(framebuffer.data(), ppu.getFramebuffer(), framebuffer.size());
-        ppu.clearFrameReady();
+    if (ppu->isFrameReady()) {
+        std::memcpy(framebuffer.data(), ppu->getFramebuffer(), framebuffer.size());
+        ppu->clearFrameReady();
     }
 }
 
@@ -66,6 +79,17 @@ void Gameboy::setButton(int button, bool pressed) {
     joypad.setButton(button, pressed);
 }
 
+void Gameboy::setButtonMask(uint32_t mask) {
+    joypad.setButtons(static_cast<uint8_t>(mask));
+}
+
+void Gameboy::setButtonMaskAt(uint32_t mask, double framePosition) {
+    // frameEnd est aussi le début de la prochaine frame émulée
+    framePosition = std::clamp(framePosition, 0.0, 1.0);
+    uint64_t offset = static_cast<uint64_t>(framePosition * Config::GB_CYCLES_PER_FRAME);
+    joypad.queueButtons(static_cast<uint8_t>(mask), frameEnd + offset);
+}
+
 const uint8_t* Gameboy::getMemoryPtr() const {
     return memory.getMemoryPtr();
 }
\ No newline at end of file
@@ -6,11 +6,15 @@
 #include "core/gameboy/GB_PPU.h"
 #include "core/gameboy/GB_Joypad.h"
 #include "core/gameboy/GB_Timer.h"
+#include "core/gameboy/GB_Scheduler.h"
+#include "core/gameboy/GB_Interrupts.h"
+#include "core/gameboy/GB_Serial.h"
 
 class Gameboy : public IEmulator
 {
     public:
-    Gameboy();
+    // Le modèle de PPU est fixé à la construction : pas de bascule en cours de jeu
+    explicit Gameboy(GB_PPUModel ppuModel = GB_PPUModel::Scanline);
     ~Gameboy() = default;
 
     bool loadROM(const std::string& path) override;
@@ -23,23 +27,36 @@ class Gameboy : public IEmulator
     int getScreenHeight() const override { return 144; }
 
     void setButton(int button, bool pressed) override;
+    void setButtonMask(uint32_t mask) override;
+    void setButtonMaskAt(uint32_t mask, double framePosition) override;
     std::string getArchName() const override { return "Game Boy"; }
 
     const uint8_t* getMemoryPtr() const override;
     size_t getMemorySize() const override { return 0x10000; }  // 64KB
     uint16_t getPC() const override {return cpu.pc;}
 
+    // Moteur du CPU : l'interpréteur par défaut, le cache de blocs pour les
+    // exécutions sans affichage, le JIT si compilé avec BUILD_GB_JIT
+    // (résultats identiques)
+    void setCPUBackend(GB_CPUBackend backend) { cpu.setBackend(backend); }
+
     const GB_CPU& getCPU() const { return cpu; }
     const GB_MMU& getMemory() const { return memory; }
+    const GB_PPU& getPPU() const { return *ppu; }
+    GB_Serial& getSerial() { return serial; }
 
 private:
+    GB_Scheduler scheduler;
+    GB_Interrupts interrupts;
     GB_MMU memory;
     GB_CPU cpu;
-    GB_PPU ppu;
+    std::unique_ptr<GB_PPU> ppu;
     GB_Joypad joypad;
     GB_Timer timer;
+    GB_Serial serial;
 
 
     std::array<uint8_t, 160 * 144 * 4> framebuffer{};
     bool romLoaded = false;
+    uint64_t frameEnd = 0;  // Fin de la frame courante (horloge maître)
 };
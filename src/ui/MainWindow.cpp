@@ -212,7 +212,7 @@ void MainWindow::renderMemoryWatch(IEmulator* emulator) {
             ImGui::Columns(2, nullptr, false);
 
             // Registres 16-bit
-            ImGui::Text("AF: 0x%04X", cpu.af);
+            ImGui::Text("AF: 0x%04X", cpu.getAF());
             ImGui::NextColumn();
             ImGui::Text("BC: 0x%04X", cpu.bc);
             ImGui::NextColumn();
@@ -231,7 +231,7 @@ void MainWindow::renderMemoryWatch(IEmulator* emulator) {
             ImGui::Separator();
 
             // Flags
-            uint8_t flags = cpu.f;
+            uint8_t flags = cpu.getF();
             ImGui::Text("Flags: %c%c%c%c",
                 flags & 0x80 ? 'Z' : '-',
                 flags & 0x40 ? 'N' : '-',
@@ -242,6 +242,11 @@ void MainWindow::renderMemoryWatch(IEmulator* emulator) {
             ImGui::Separator();
             ImGui::Text("Cycles: %d", cpu.getCycles());
             ImGui::Text("Halted: %s", cpu.isHalted() ? "Yes" : "No");
+
+            const auto& idle = cpu.getIdleLoopStats();
+            ImGui::Text("Idle loops skipped: %llu (%llu cycles)",
+                static_cast<unsigned long long>(idle.skips),
+                static_cast<unsigned long long>(idle.skippedCycles));
         }
     }
 #endif
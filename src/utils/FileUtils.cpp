@@ -5,6 +5,8 @@
 
 #include <fstream>
 #include <filesystem>
+#include <mutex>
+#include <unordered_map>
 
 
 
@@ -45,6 +47,49 @@ std::string FileUtils::openFileDialog(
     return path;
 }
 
+FileUtils::RomImagePtr FileUtils::openRomImage(const std::string& path) {
+    // Cache des images ouvertes : weak_ptr pour que la dernière instance qui
+    // lâche la ROM libère le buffer
+    static std::mutex cacheMutex;
+    static std::unordered_map<std::string, std::weak_ptr<const RomImage>> cache;
+
+    std::error_code ec;
+    std::string key = std::filesystem::weakly_canonical(path, ec).string();
+    if (ec) key = path;
+
+    auto writeTime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        LOG_ERROR("Failed to open file: {}", path);
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        if (auto image = it->second.lock(); image && image->writeTime == writeTime) {
+            return image;
+        }
+    }
+
+    std::shared_ptr<RomImage> image(new RomImage());
+    image->path = path;
+    image->writeTime = writeTime;
+
+    // ROM de 8 Mo au plus : la copie est bornée et l'image ne dépend plus du fichier
+    image->buffer = readBinaryFile(path);
+    if (image->buffer.empty()) return nullptr;
+    image->bytes = image->buffer.data();
+    image->length = image->buffer.size();
+
+    // Purge des images que plus personne n'utilise
+    for (auto entry = cache.begin(); entry != cache.end();) {
+        entry = entry->second.expired() ? cache.erase(entry) : std::next(entry);
+    }
+    cache[key] = image;
+    return image;
+}
+
 std::vector<uint8_t> FileUtils::readBinaryFile(const std::string& path) {
     std::ifstream file(path, std::ios::binary | std::ios::ate);
 
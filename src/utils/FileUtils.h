@@ -1,9 +1,44 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <memory>
+#include <filesystem>
 #include "common/types.h"
 
 namespace FileUtils {
+    // Image de ROM en lecture seule, lue une fois en mémoire et partagée entre
+    // toutes les instances qui ouvrent le même fichier. Pas de mmap : une ROM
+    // tronquée ou régénérée sur place pendant l'exécution (boucle
+    // édition/compilation en homebrew) ferait planter la lecture suivante (SIGBUS).
+    class RomImage {
+    public:
+        RomImage(const RomImage&) = delete;
+        RomImage& operator=(const RomImage&) = delete;
+
+        const uint8_t* data() const { return bytes; }
+        size_t size() const { return length; }
+        bool empty() const { return length == 0; }
+        uint8_t operator[](size_t i) const { return bytes[i]; }
+
+        const std::string& getPath() const { return path; }
+
+    private:
+        friend std::shared_ptr<const RomImage> openRomImage(const std::string& path);
+        RomImage() = default;
+
+        std::string path;
+        std::filesystem::file_time_type writeTime{};
+        const uint8_t* bytes = nullptr;
+        size_t length = 0;
+        std::vector<uint8_t> buffer;
+    };
+
+    using RomImagePtr = std::shared_ptr<const RomImage>;
+
+    // Ouvre une ROM, ou renvoie l'image déjà ouverte si le fichier n'a pas
+    // changé depuis. nullptr en cas d'échec.
+    RomImagePtr openRomImage(const std::string& path);
+
     // Lecture de fichiers
     std::vector<uint8_t> readBinaryFile(const std::string& path);
 
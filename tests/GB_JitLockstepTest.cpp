@@ -0,0 +1,209 @@
+// Test en parallèle du JIT : la même ROM tourne sous l'interpréteur, le cache
+// de blocs et le JIT, et après chaque frame les registres, la mémoire de
+// 0x8000 à 0xFFFF et l'image doivent être identiques.
+//
+// Sans argument, des ROM synthétiques sont générées (code aléatoire mais
+// reproductible, interruptions VBlank et timer, HALT, attente de LY).
+// Des chemins de ROM peuvent être passés en argument en plus.
+
+#include "core/gameboy/Gameboy.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int FRAMES = 600;
+
+enum class RomMode { Mixed, Halt, Poll };
+
+// ROM sans MBC : un bloc de code aléatoire rejoué en boucle
+std::vector<uint8_t> buildRom(uint32_t seed, RomMode mode) {
+    std::mt19937 rng(seed);
+    auto random = [&](uint32_t n) { return static_cast<uint8_t>(rng() % n); };
+    auto chance = [&](double p) { return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < p; };
+
+    std::vector<uint8_t> rom(0x8000, 0x00);
+    const uint8_t entry[] = {0x00, 0xC3, 0x50, 0x01};                                 // NOP ; JP 0x0150
+    const uint8_t vblank[] = {0xF5, 0xF0, 0x80, 0x3C, 0xE0, 0x80, 0xF1, 0xD9};        // PUSH AF ; INC (FF80) ; POP AF ; RETI
+    const uint8_t timer[] = {0xF5, 0xF0, 0x81, 0x3C, 0xE0, 0x81, 0xF1, 0xD9};         // PUSH AF ; INC (FF81) ; POP AF ; RETI
+    const uint8_t routine[] = {0x80, 0xA9, 0x3C, 0xC9};                               // ADD A, B ; XOR C ; INC A ; RET
+    std::memcpy(&rom[0x0100], entry, sizeof(entry));
+    std::memcpy(&rom[0x0040], vblank, sizeof(vblank));
+    std::memcpy(&rom[0x0050], timer, sizeof(timer));
+    std::memcpy(&rom[0x1000], routine, sizeof(routine));
+
+    std::vector<uint8_t> code = {
+        0x31, 0xFE, 0xDF,        // LD SP, 0xDFFE
+        0x3E, 0x05, 0xE0, 0xFF,  // IE = VBlank | Timer
+        0x3E, 0x05, 0xE0, 0x07,  // TAC : timer actif, 4096 Hz / 4
+        0xFB,                    // EI
+    };
+    const uint16_t loop = static_cast<uint16_t>(0x0150 + code.size());
+    auto emit = [&](std::initializer_list<uint8_t> bytes) { code.insert(code.end(), bytes); };
+
+    // Registres 8 bits sauf (HL)
+    const uint8_t regs[] = {0, 1, 2, 3, 4, 5, 7};
+    auto reg = [&]() { return regs[random(7)]; };
+
+    for (int i = 0; i < 400; ++i) {
+        const uint32_t k = random(100);
+        if (k < 25) {
+            emit({static_cast<uint8_t>(0x40 | (reg() << 3) | reg())});                     // LD r, r
+        } else if (k < 45) {
+            emit({static_cast<uint8_t>(0x80 | (random(8) << 3) | reg())});                 // ALU A, r
+        } else if (k < 50) {
+            emit({static_cast<uint8_t>(0xC6 | (random(8) << 3)), random(256)});            // ALU A, n
+        } else if (k < 58) {
+            emit({static_cast<uint8_t>((reg() << 3) | (4 + random(2)))});                  // INC/DEC r
+        } else if (k < 62) {
+            emit({static_cast<uint8_t>(0x06 | (reg() << 3)), random(256)});                // LD r, n
+        } else if (k < 70) {
+            emit({0xCB, static_cast<uint8_t>((random(256) & ~0x07) | reg())});             // préfixe CB
+        } else if (k < 75) {
+            // Accès par (HL) en WRAM, écritures comprises
+            static const uint8_t hlOps[] = {0x34, 0x35, 0x46, 0x4E, 0x7E, 0x86, 0x8E, 0x96, 0x9E,
+                                            0xA6, 0xAE, 0xB6, 0xBE, 0x70, 0x77, 0x22, 0x2A, 0x32, 0x3A};
+            emit({0x21, random(256), static_cast<uint8_t>(0xC0 + random(0x10))});          // LD HL, 0xCxxx
+            if (chance(0.2)) emit({0xCB, static_cast<uint8_t>((random(256) & ~0x07) | 6)});
+            else emit({hlOps[random(sizeof(hlOps))]});
+        } else if (k < 79) {
+            static const uint8_t misc[] = {0x07, 0x0F, 0x17, 0x1F, 0x27, 0x2F, 0x37, 0x3F};
+            emit({misc[random(8)]});                                                       // rotations, DAA, CPL, SCF, CCF
+        } else if (k < 82) {
+            static const uint8_t pairs[] = {0x03, 0x13, 0x0B, 0x1B, 0x09, 0x19, 0x29};
+            emit({pairs[random(7)]});                                                      // INC/DEC/ADD HL, rr
+        } else if (k < 85) {
+            static const uint8_t push[] = {0xC5, 0xD5, 0xF5, 0xE5};
+            static const uint8_t pop[] = {0xC1, 0xD1, 0xE1};
+            emit({push[random(4)], pop[random(3)]});
+        } else if (k < 88) {
+            emit({static_cast<uint8_t>(0x20 | (random(4) << 3)), 0x00});                  // JR cc, +0
+        } else if (k < 90) {
+            emit({0xCD, 0x00, 0x10});                                                      // CALL 0x1000
+        } else if (k < 93) {
+            static const uint8_t io[] = {0x44, 0x41, 0x04, 0x05, 0x80};
+            emit({0xF0, io[random(5)]});                                                   // LDH A, (LY/STAT/DIV/TIMA/HRAM)
+        } else if (k < 95) {
+            emit({0xE8, random(256), 0x31, 0xFE, 0xDF});                                   // ADD SP, e ; LD SP, 0xDFFE
+        } else if (k < 97) {
+            emit({0xF8, random(256)});                                                     // LD HL, SP + e
+        } else {
+            emit({0x3E, random(256), 0xEA, random(256), static_cast<uint8_t>(0xC0 + random(0x10))});  // LD (nn), A
+        }
+
+        if (mode == RomMode::Halt && chance(0.01)) emit({0x76, 0x00});                   // HALT
+        if (mode == RomMode::Poll && chance(0.01)) {
+            emit({0xF0, 0x44, 0xFE, 0x90, 0x20, 0xFA});                                    // attente de LY == 144
+        }
+    }
+    emit({0xC3, static_cast<uint8_t>(loop & 0xFF), static_cast<uint8_t>(loop >> 8)});
+
+    std::memcpy(&rom[0x0150], code.data(), code.size());
+    return rom;
+}
+
+bool writeRom(const std::filesystem::path& path, const std::vector<uint8_t>& rom) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(rom.data()), static_cast<std::streamsize>(rom.size()));
+    return static_cast<bool>(file);
+}
+
+struct Snapshot {
+    uint16_t af, bc, de, hl, sp, pc;
+    bool ime, halted;
+};
+
+Snapshot snapshot(const Gameboy& gb) {
+    const GB_CPU& cpu = gb.getCPU();
+    return {cpu.getAF(), cpu.bc, cpu.de, cpu.hl, cpu.sp, cpu.pc, cpu.isIME(), cpu.isHalted()};
+}
+
+// Rend un message décrivant la première différence, vide si aucune
+std::string compare(const Gameboy& reference, const Gameboy& other) {
+    const Snapshot a = snapshot(reference);
+    const Snapshot b = snapshot(other);
+    char text[160];
+    if (std::memcmp(&a, &b, offsetof(Snapshot, ime)) != 0 || a.ime != b.ime || a.halted != b.halted) {
+        std::snprintf(text, sizeof(text),
+                      "registers AF=%04x/%04x BC=%04x/%04x DE=%04x/%04x HL=%04x/%04x SP=%04x/%04x PC=%04x/%04x",
+                      a.af, b.af, a.bc, b.bc, a.de, b.de, a.hl, b.hl, a.sp, b.sp, a.pc, b.pc);
+        return text;
+    }
+
+    const uint8_t* memA = reference.getMemoryPtr();
+    const uint8_t* memB = other.getMemoryPtr();
+    for (uint32_t addr = 0x8000; addr <= 0xFFFF; ++addr) {
+        if (memA[addr] != memB[addr]) {
+            std::snprintf(text, sizeof(text), "memory [%04x] = %02x/%02x", addr, memA[addr], memB[addr]);
+            return text;
+        }
+    }
+
+    const size_t frameSize = 160 * 144 * 4;
+    if (std::memcmp(reference.getFramebuffer(), other.getFramebuffer(), frameSize) != 0) return "framebuffer";
+    return {};
+}
+
+// Interpréteur comme référence, cache de blocs et JIT comparés frame par frame
+bool runLockstep(const std::string& path) {
+    Gameboy interpreter, blockCache, jit;
+    if (!interpreter.loadROM(path) || !blockCache.loadROM(path) || !jit.loadROM(path)) {
+        std::printf("FAIL %s: cannot load ROM\n", path.c_str());
+        return false;
+    }
+    blockCache.setCPUBackend(GB_CPUBackend::BlockCache);
+    jit.setCPUBackend(GB_CPUBackend::Jit);
+    if (jit.getCPU().getBackend() != GB_CPUBackend::Jit) {
+        std::printf("FAIL %s: JIT unavailable\n", path.c_str());
+        return false;
+    }
+
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        interpreter.runFrame();
+        blockCache.runFrame();
+        jit.runFrame();
+
+        for (const auto& [name, gb] : {std::pair<const char*, Gameboy*>{"block cache", &blockCache}, {"JIT", &jit}}) {
+            const std::string diff = compare(interpreter, *gb);
+            if (!diff.empty()) {
+                std::printf("FAIL %s: %s diverges at frame %d: %s\n", path.c_str(), name, frame, diff.c_str());
+                return false;
+            }
+        }
+    }
+
+    std::printf("OK   %s: %d frames, %llu blocks run\n", path.c_str(), FRAMES,
+                static_cast<unsigned long long>(jit.getCPU().getBlockCacheStats().executed));
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool ok = true;
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const struct { uint32_t seed; RomMode mode; } roms[] = {
+        {1, RomMode::Mixed}, {2, RomMode::Mixed}, {3, RomMode::Halt}, {4, RomMode::Poll},
+    };
+    for (const auto& rom : roms) {
+        const std::filesystem::path path = dir / ("gb_jit_lockstep_" + std::to_string(rom.seed) + ".gb");
+        if (!writeRom(path, buildRom(rom.seed, rom.mode))) {
+            std::printf("FAIL %s: cannot write ROM\n", path.string().c_str());
+            ok = false;
+            continue;
+        }
+        ok &= runLockstep(path.string());
+        std::filesystem::remove(path);
+    }
+
+    for (int i = 1; i < argc; ++i) ok &= runLockstep(argv[i]);
+    return ok ? 0 : 1;
+}